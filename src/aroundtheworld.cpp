@@ -1,45 +1,327 @@
 ﻿
+#include "aroundtheworld.hpp"
+#include "autopilot.hpp"
 #include "configuration.hpp"
+#include "input.hpp"
+#include "profiler.hpp"
+#include "recording.hpp"
+#include "rewind.hpp"
 #include "earth.hpp"
-#include "refresher.hpp"
 #include "satellite.hpp"
+#include "scheduler.hpp"
 #include "shield.hpp"
+#include "terminal.hpp"
+#include "triplebuffer.hpp"
 #include "universe.hpp"
 #include "utilities.hpp"
+#include <fmt/format.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
 
 namespace atw {
 
-static Event translateEvent(ftxui::Event e)
+// Set when the terminal is resized, by the signal's handler or the console's events
+static std::atomic<bool> terminalResized{};
+
+static void enterGameScreen()
+{
+  std::cout << TerminalWriter::EnterAlternateScreen << TerminalWriter::HideCursor << TerminalWriter::EnableMouse
+            << std::flush;
+}
+
+static void leaveGameScreen()
+{
+  std::cout << TerminalWriter::DisableMouse << TerminalWriter::ShowCursor << TerminalWriter::LeaveAlternateScreen
+            << std::flush;
+}
+
+// Terminal in raw mode for the game, on its alternate screen: the keys and the mouse's moves are read as they come,
+// without echo. Its modes and screen are restored on destruction.
+#ifdef _WIN32
+class Console
+{
+  HANDLE input{ GetStdHandle(STD_INPUT_HANDLE) };
+  HANDLE output{ GetStdHandle(STD_OUTPUT_HANDLE) };
+  DWORD savedInputMode{};
+  DWORD savedOutputMode{};
+  std::array<INPUT_RECORD, 64> records{};
+  std::string bytes{};
+
+public:
+  Console()
+  {
+    GetConsoleMode(input, &savedInputMode);
+    GetConsoleMode(output, &savedOutputMode);
+    // The keys and the mouse's reports come as the same escape sequences as on the other terminals
+    SetConsoleMode(input, ENABLE_VIRTUAL_TERMINAL_INPUT | ENABLE_WINDOW_INPUT | ENABLE_EXTENDED_FLAGS);
+    SetConsoleMode(output, savedOutputMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+    enterGameScreen();
+  }
+
+  Console(const Console &) = delete;
+  Console &operator=(const Console &) = delete;
+
+  ~Console()
+  {
+    leaveGameScreen();
+    SetConsoleMode(input, savedInputMode);
+    SetConsoleMode(output, savedOutputMode);
+  }
+
+  // Called once the other threads are started
+  void watchResizes() noexcept {}
+
+  // Waits for the next bytes, which are empty after a resize, and none when the input is closed
+  std::optional<std::string_view> read()
+  {
+    DWORD count = 0;
+    if (!ReadConsoleInputA(input, records.data(), static_cast<DWORD>(records.size()), &count)) return std::nullopt;
+    bytes.clear();
+    for (DWORD i = 0; i < count; ++i) {
+      const auto &record = records[i];
+      if (record.EventType == WINDOW_BUFFER_SIZE_EVENT) terminalResized = true;
+      if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown && record.Event.KeyEvent.uChar.AsciiChar != 0)
+        bytes.append(record.Event.KeyEvent.wRepeatCount, record.Event.KeyEvent.uChar.AsciiChar);
+    }
+    return bytes;
+  }
+};
+#else
+class Console
+{
+  termios savedMode{};
+  sigset_t resizeSignal{};
+  std::array<char, 256> buffer{};
+
+  static void onResize(int) { terminalResized = true; }
+
+public:
+  Console()
+  {
+    tcgetattr(STDIN_FILENO, &savedMode);
+    auto mode = savedMode;
+    mode.c_iflag &= ~static_cast<tcflag_t>(ICRNL | IXON);
+    mode.c_lflag &= ~static_cast<tcflag_t>(ECHO | ICANON | ISIG | IEXTEN);
+    mode.c_cc[VMIN] = 1;
+    mode.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+    // Blocked in the threads started afterwards, so that the signal interrupts the reading thread
+    sigemptyset(&resizeSignal);
+    sigaddset(&resizeSignal, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &resizeSignal, nullptr);
+    enterGameScreen();
+  }
+
+  Console(const Console &) = delete;
+  Console &operator=(const Console &) = delete;
+
+  ~Console()
+  {
+    leaveGameScreen();
+    std::signal(SIGWINCH, SIG_DFL);
+    tcsetattr(STDIN_FILENO, TCSANOW, &savedMode);
+  }
+
+  // Called once the other threads are started
+  void watchResizes() noexcept
+  {
+    struct sigaction action{};
+    action.sa_handler = onResize;
+    // Without SA_RESTART, so that the signal interrupts the reading
+    sigaction(SIGWINCH, &action, nullptr);
+    pthread_sigmask(SIG_UNBLOCK, &resizeSignal, nullptr);
+  }
+
+  // Waits for the next bytes, which are empty after a resize, and none when the input is closed
+  std::optional<std::string_view> read()
+  {
+    const auto count = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+    if (count < 0 && errno == EINTR) return std::string_view{};
+    if (count <= 0) return std::nullopt;
+    return std::string_view{ buffer.data(), static_cast<std::size_t>(count) };
+  }
+};
+#endif
+
+static Event translateInput(const TerminalReader::Input &input)
 {
-  if (e.is_mouse()) {
+  switch (input.key) {
+  case TerminalReader::Key::Mouse:
     return {
       EventType::Mouse,
-      Point{ static_cast<double>(e.mouse().x * MouseRatioX), static_cast<double>(e.mouse().y * MouseRatioY) },
+      Point{ toScalar(static_cast<double>(input.x * MouseRatioX)),
+        toScalar(static_cast<double>(input.y * MouseRatioY)) },
     };
+  case TerminalReader::Key::Left:
+    return { EventType::Left };
+  case TerminalReader::Key::Right:
+    return { EventType::Right };
+  case TerminalReader::Key::Return:
+    return { EventType::Start };
+  case TerminalReader::Key::Backspace:
+    return { EventType::Rewind };
+  case TerminalReader::Key::Character:
+  case TerminalReader::Key::Escape:
+  default:
+    return { EventType::Unknown };
   }
-  if (e == ftxui::Event::ArrowLeft) { return { EventType::Left }; }
-  if (e == ftxui::Event::ArrowRight) { return { EventType::Right }; }
-  if (e == ftxui::Event::Return) { return { EventType::Start }; }
-  if (e == ftxui::Event::Custom) { return { EventType::Frame }; }
-  return { EventType::Unknown };
 }
 
-void play()
+// Average and 99th percentile durations of the frames' phases, in milliseconds
+static void drawProfile(ftxui::Elements &panel)
 {
-  auto screen = ftxui::ScreenInteractive::TerminalOutput();
+  const auto milliseconds = [](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  panel.push_back(ftxui::separator());
+  panel.push_back(ftxui::text("Phase     avg ms  p99 ms"));
+  const auto statistics = profiler.statistics();
+  for (std::size_t i = 0; i < statistics.size(); ++i)
+    panel.push_back(ftxui::text(fmt::format("{:<8} {:7.3f} {:7.3f}",
+      PhaseNames[i],
+      milliseconds(statistics[i].average),
+      milliseconds(statistics[i].p99))));
+}
+
+void play(const Settings &settings, const PlayOptions &options)
+{
+  const auto start = std::chrono::steady_clock::now();
+  Universe universe{ start, settings };
+  Rewind rewind{ universe };
+  std::optional<Autopilot> autopilot{};
+  if (options.autopilot) autopilot.emplace(universe);
+
+  std::ofstream recordFile{};
+  std::optional<Recorder> recorder{};
+  if (!options.recordPath.empty()) {
+    recordFile.open(options.recordPath, std::ios::binary);
+    if (!recordFile) throw std::runtime_error(fmt::format("cannot write the recording '{}'", options.recordPath));
+    recorder.emplace(recordFile, start, settings);
+  }
 
-  Refresher refresher{ screen, FrameInterval };
+  Input input{};
+  TripleBuffer<Snapshot> snapshots{};
+  universe.snapshot(snapshots.getBack());
+  snapshots.publish();
 
-  Universe universe{ std::chrono::steady_clock::now(), randomSatellite };
+  Painter painter{};
+  TerminalWriter writer{};
+  std::atomic<bool> showProfile{};
+  std::atomic<bool> redraw{};
+  if (!options.tracePath.empty()) profiler.enable(true);
 
-  auto renderer = ftxui::Renderer([&]() { return universe.draw(); });
+  Console console{};
 
-  auto events_catcher = ftxui::CatchEvent(renderer, [&](ftxui::Event e) {
-    universe.update(std::chrono::steady_clock::now(), translateEvent(std::move(e)));
-    return false;
+  // The drawing thread draws the latest snapshot, when asked, and the writer writes the changed cells of the frame:
+  // it is the only output to the terminal. Its interval is so short that it draws as soon as it is woken.
+  // A frame is only drawn for a new snapshot, or when needed.
+  std::optional<Scheduler> drawing{};
+  drawing.emplace(std::chrono::nanoseconds{ 1 }, [&] {
+    if (!snapshots.isFresh() && !redraw.exchange(false)) return Scheduler::Never;
+    // After a resize, the terminal's cells are not the ones written anymore
+    if (terminalResized.exchange(false)) writer.invalidate();
+    ftxui::Elements panel{ ftxui::text("Bytes/frame: " + std::to_string(writer.getLastFrameBytes())),
+      ftxui::text(fmt::format("Events: {}/{}", input.getAppliedCount(), input.getReceivedCount())) };
+    if (showProfile) drawProfile(panel);
+    ftxui::Element frame{};
+    {
+      const PhaseTimer timer{ Phase::Draw };
+      frame = snapshots.getLatest().draw(painter, std::move(panel));
+    }
+    const PhaseTimer timer{ Phase::Render };
+    auto frameScreen = ftxui::Screen::Create(ftxui::Dimension::Fit(frame));
+    ftxui::Render(frameScreen, frame);
+    std::cout << writer.update(frameScreen) << std::flush;
+    return Scheduler::Never;
   });
 
-  screen.Loop(events_catcher);
+  // The scheduler's thread runs the simulation: each frame, it applies the coalesced input events, steps the universe,
+  // and publishes a snapshot of it, then wakes the drawing thread.
+  // A snapshot is only published when it would be drawn differently, and the scheduler sleeps until the universe's
+  // next visible change, or the next input, so that an idle game uses no CPU.
+  // The universe is only accessed by this thread, until the scheduler is stopped.
+  std::optional<Scheduler> scheduler{};
+  // Hash of the last published snapshot, if it was taken out of the game
+  std::optional<std::uint64_t> publishedHash{};
+  scheduler.emplace(settings.frameInterval, [&] {
+    const auto now = std::chrono::steady_clock::now();
+    {
+      const PhaseTimer timer{ Phase::Update };
+      const auto apply = [&](const Event &event) {
+        if (recorder) recorder->record(now, event);
+        applyEvent(universe, rewind, now, event);
+      };
+      input.apply([&](const Event &event) {
+        const auto steersShield =
+          event.type == EventType::Mouse || event.type == EventType::Left || event.type == EventType::Right;
+        if (!autopilot || !steersShield) apply(event);
+      });
+      if (autopilot && universe.getState() == State::Play) apply(autopilot->plan(universe));
+      apply({ EventType::Frame });
+    }
+    universe.snapshot(snapshots.getBack());
+    // During the game, the satellites move at each frame, so that the snapshot is only hashed out of it
+    std::optional<std::uint64_t> hash{};
+    if (universe.getState() != State::Play) hash = snapshots.getBack().hash();
+    if (!hash || hash != publishedHash) {
+      publishedHash = hash;
+      snapshots.publish();
+      drawing->wake();
+    }
+    return universe.getNextVisibleChange();
+  });
+  console.watchResizes();
+
+  // The main thread reads the terminal until [ESCAPE], which lets the recording end with the final state.
+  // [P] shows or hides the profile of the frames' phases.
+  TerminalReader reader{};
+  bool quit = false;
+  while (!quit) {
+    const auto bytes = console.read();
+    if (!bytes) break;
+    if (terminalResized) {
+      redraw = true;
+      drawing->wake();
+    }
+    reader.parse(*bytes, [&](const TerminalReader::Input &terminalInput) {
+      if (terminalInput.key == TerminalReader::Key::Escape) quit = true;
+      if (terminalInput.key == TerminalReader::Key::Character && terminalInput.character == 'p') {
+        showProfile = !showProfile;
+        profiler.enable(showProfile || !options.tracePath.empty());
+        redraw = true;
+        drawing->wake();
+      }
+      const auto event = translateInput(terminalInput);
+      if (quit || event.type == EventType::Unknown) return;
+      input.push(event);
+      scheduler->wake();
+    });
+  }
+
+  scheduler.reset();
+  drawing.reset();
+  if (recorder) recorder->finish(universe.hash());
+  if (!options.tracePath.empty()) profiler.writeTrace(options.tracePath);
 }
 
 }// namespace atw
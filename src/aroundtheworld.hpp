@@ -1,7 +1,44 @@
 #pragma once
 
+#include "configuration.hpp"
+#include <cstddef>
+#include <string>
+
 namespace atw {
 
-void play();
+struct HeadlessOptions
+{
+  std::size_t frames{};
+  std::string tracePath{};
+  // The shield is steered by the autopilot, instead of sweeping the orbit
+  bool autopilot{};
+};
+
+struct BatchOptions
+{
+  std::size_t universesCount{};
+  // Cap on the frames played by each universe
+  std::size_t frames{};
+};
+
+struct PlayOptions
+{
+  // Where to record the game's events, if not empty
+  std::string recordPath{};
+  // Where to write the trace of the frames' phases, if not empty
+  std::string tracePath{};
+  // The shield is steered by the autopilot, and the mouse and the arrows are ignored
+  bool autopilot{};
+};
+
+void play(const Settings &settings, const PlayOptions &options = {});
+
+void playHeadless(const Settings &settings, const HeadlessOptions &options);
+
+// Plays many universes on all the cores, the shield sweeping the orbit, and reports their survival and points
+void playBatch(const Settings &settings, const BatchOptions &options);
+
+// Returns false if the replayed game does not end in the recorded state
+bool replay(const std::string &recordPath);
 
-}
+}// namespace atw
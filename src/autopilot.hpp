@@ -0,0 +1,127 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "random.hpp"
+#include "universe.hpp"
+#include "utilities.hpp"
+#include "workers.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+namespace atw {
+
+// Steers the shield in place of the player, with Monte Carlo rollouts of the game a few seconds ahead.
+// Each frame, the universe is saved into a keyframe, and restored into universes allocated upfront, one per rollout,
+// which play on the workers without allocating. Each candidate mouse position around the Earth is played
+// by several rollouts: the first one holds it, the others start from it and wander around the orbit at random.
+// The chosen candidate is the one whose rollouts keep the Earth alive the longest, the current one winning ties.
+// The horizon shrinks when the planning takes longer than its budget, so that the frames keep their deadlines,
+// and grows back when there is time left.
+// The mouse positions are integers, like the terminal's ones, so that the games are recorded exactly.
+class Autopilot
+{
+  std::array<Point, AutopilotCandidatesCount> candidates{};
+  Universe::Keyframe keyframe{};
+  std::vector<Universe> rollouts{};
+  std::vector<std::size_t> survivals{};
+  std::chrono::steady_clock::duration frameInterval{};
+  std::chrono::steady_clock::duration budget{};
+  std::size_t maxHorizon{};
+  std::size_t horizon{};
+  std::size_t current{};
+  std::uint64_t seed{};
+  std::uint64_t plansCount{};
+  std::chrono::steady_clock::duration lastPlanDuration{};
+
+  std::size_t rollout(std::size_t i)
+  {
+    auto &universe = rollouts[i];
+    universe.restore(keyframe);
+    Random random{ seed + plansCount * rollouts.size() + i };
+    auto candidate = static_cast<int>(i / AutopilotRolloutsCount);
+    const auto wanders = i % AutopilotRolloutsCount != 0;
+    auto now = keyframe.lastFrameTime;
+    std::size_t frame = 0;
+    for (; frame < horizon && universe.getState() == State::Play; ++frame) {
+      if (wanders && frame > 0)
+        candidate = (candidate + random.uniform(-1, 1) + static_cast<int>(AutopilotCandidatesCount))
+                    % static_cast<int>(AutopilotCandidatesCount);
+      now += frameInterval;
+      universe.update(now, { EventType::Mouse, candidates[static_cast<std::size_t>(candidate)] });
+      universe.update(now, { EventType::Frame });
+    }
+    return frame;
+  }
+
+public:
+  // The rollouts play with the universe's settings, but with a destructible Earth, to see when it is hit
+  explicit Autopilot(const Universe &universe, std::chrono::steady_clock::duration planBudget = AutopilotBudget)
+    : frameInterval{ universe.getSettings().frameInterval }, budget{ planBudget },
+      maxHorizon{ std::max(AutopilotMinHorizonFrames,
+        static_cast<std::size_t>(std::chrono::steady_clock::duration{ AutopilotHorizon } / frameInterval)) },
+      horizon{ maxHorizon }, seed{ universe.getSettings().seed }
+  {
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+      const auto angle = 2 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(candidates.size());
+      candidates[i] = { toScalar(std::round(toDouble(EarthCenter.x) + ShieldRadius * std::cos(angle))),
+        toScalar(std::round(toDouble(EarthCenter.y) + ShieldRadius * std::sin(angle))) };
+    }
+
+    auto settings = universe.getSettings();
+    settings.indestructibleEarth = false;
+    settings.parallelSatellitesCount = std::numeric_limits<std::size_t>::max();
+    const auto capacity = universe.getSatellitesCapacity();
+    keyframe.satellites.reserveState(capacity);
+    keyframe.grid.reserve(capacity);
+    rollouts.reserve(candidates.size() * AutopilotRolloutsCount);
+    for (std::size_t i = 0; i < candidates.size() * AutopilotRolloutsCount; ++i)
+      rollouts.emplace_back(std::chrono::steady_clock::time_point{}, settings);
+    survivals.resize(rollouts.size());
+  }
+
+  // Returns the mouse event moving the shield where the Earth survives the longest
+  Event plan(const Universe &universe, WorkerPool &workers = workerPool())
+  {
+    const auto start = std::chrono::steady_clock::now();
+    universe.save(keyframe);
+    workers.run(rollouts.size(), [&](std::size_t i) { survivals[i] = rollout(i); });
+    ++plansCount;
+
+    std::size_t best = current;
+    std::size_t bestSurvival = 0;
+    for (std::size_t offset = 0; offset < candidates.size(); ++offset) {
+      // From the current candidate outwards, on both sides, so that the ties keep the shield still
+      const auto step = (offset + 1) / 2;
+      const auto candidate =
+        (offset % 2 == 0 ? current + step : current + candidates.size() - step) % candidates.size();
+      std::size_t survival = 0;
+      for (std::size_t r = 0; r < AutopilotRolloutsCount; ++r)
+        survival += survivals[candidate * AutopilotRolloutsCount + r];
+      if (survival > bestSurvival) {
+        best = candidate;
+        bestSurvival = survival;
+      }
+    }
+    current = best;
+
+    lastPlanDuration = std::chrono::steady_clock::now() - start;
+    if (lastPlanDuration > budget)
+      horizon = std::max(AutopilotMinHorizonFrames, horizon * 3 / 4);
+    else if (lastPlanDuration < budget / 2)
+      horizon = std::min(maxHorizon, horizon + 1);
+    return { EventType::Mouse, candidates[current] };
+  }
+
+  // Frames played ahead by the rollouts
+  std::size_t getHorizon() const noexcept { return horizon; }
+  std::chrono::steady_clock::duration getLastPlanDuration() const noexcept { return lastPlanDuration; }
+};
+
+}// namespace atw
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "universe.hpp"
+#include "workers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace atw {
+
+struct UniverseResult
+{
+  std::uint64_t seed{};
+  // Frames played, until the Earth was destroyed or the frames' cap was reached
+  std::size_t frames{};
+  std::size_t points{};
+  bool destroyed{};
+};
+
+struct BatchSummary
+{
+  std::size_t min{};
+  std::size_t median{};
+  std::size_t max{};
+  double mean{};
+};
+
+struct BatchResult
+{
+  std::vector<UniverseResult> universes{};
+  std::size_t destroyedCount{};
+  BatchSummary frames{};
+  BatchSummary points{};
+};
+
+inline BatchSummary summarize(std::vector<std::size_t> values)
+{
+  if (values.empty()) return {};
+  BatchSummary summary{};
+  double total = 0.0;
+  for (const auto value : values) total += static_cast<double>(value);
+  summary.mean = total / static_cast<double>(values.size());
+  const auto [min, max] = std::minmax_element(begin(values), end(values));
+  summary.min = *min;
+  summary.max = *max;
+  const auto median = std::next(begin(values), static_cast<std::ptrdiff_t>(values.size() / 2));
+  std::nth_element(begin(values), median, end(values));
+  summary.median = *median;
+  return summary;
+}
+
+// Plays a universe with random satellites, the policy choosing the event of each frame in place of the player:
+// policy(universe, frame) returns a Mouse, Left or Right event, or an Unknown one to do nothing
+template<typename Policy>
+UniverseResult playUniverse(const Settings &settings, std::size_t maxFrames, const Policy &policy)
+{
+  auto now = std::chrono::steady_clock::time_point{};
+  Universe universe{ now, settings };
+  universe.update(now, { EventType::Start });
+  std::size_t frame = 0;
+  for (; frame < maxFrames && universe.getState() == State::Play; ++frame) {
+    now += settings.frameInterval;
+    universe.update(now, policy(universe, frame));
+    universe.update(now, { EventType::Frame });
+  }
+  return { settings.seed, frame, universe.getPoints(), universe.getState() == State::End };
+}
+
+// Plays many universes, whose seeds follow the settings' one, on the workers.
+// The universes are the chunks, taken one at a time by the workers, so that the slow ones do not hold back the others,
+// and each universe is updated on a single thread. They share nothing but the policy, which must not change.
+// The results are in the order of the seeds, whatever the number of workers.
+template<typename Policy>
+BatchResult runBatch(const Settings &settings,
+  std::size_t universesCount,
+  std::size_t maxFrames,
+  const Policy &policy,
+  WorkerPool &workers = workerPool())
+{
+  BatchResult result{};
+  result.universes.resize(universesCount);
+  workers.run(universesCount, [&](std::size_t i) {
+    auto universeSettings = settings;
+    universeSettings.seed = settings.seed + i;
+    universeSettings.parallelSatellitesCount = std::numeric_limits<std::size_t>::max();
+    result.universes[i] = playUniverse(universeSettings, maxFrames, policy);
+  });
+
+  std::vector<std::size_t> frames{};
+  std::vector<std::size_t> points{};
+  frames.reserve(universesCount);
+  points.reserve(universesCount);
+  for (const auto &universe : result.universes) {
+    frames.push_back(universe.frames);
+    points.push_back(universe.points);
+    if (universe.destroyed) ++result.destroyedCount;
+  }
+  result.frames = summarize(std::move(frames));
+  result.points = summarize(std::move(points));
+  return result;
+}
+
+}// namespace atw
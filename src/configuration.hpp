@@ -3,6 +3,8 @@
 
 #include "utilities.hpp"
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <numbers>
 
 namespace atw {
@@ -19,16 +21,61 @@ static constexpr int MouseRatioX = 2;
 static constexpr int MouseRatioY = 4;
 static constexpr Point ShieldLeft{ -ShieldSpan, -ShieldRadius };
 static constexpr Point ShieldRight{ +ShieldSpan, -ShieldRadius };
-static constexpr double ShieldAngleStep = std::numbers::pi / 16.0;
+static constexpr Scalar ShieldAngleStep = Pi<> / Scalar{ 16 };
 static constexpr Offset CenterOffset{ EarthCenter.x, EarthCenter.y };
 static constexpr std::size_t InitialSatellitesCount = 3;
+static constexpr std::size_t ParallelSatellitesCount = 20000;
+static constexpr std::size_t MaxSatellitesCount = 1000;
 static constexpr int SatelliteRadius = 2;
 static constexpr auto SatelliteCreationInterval = 5s;
-static constexpr double SatelliteMinSpeed = 1.0;
-static constexpr double SatelliteMaxSpeed = 2.5;
+static constexpr Scalar SatelliteMinSpeed{ 1.0 };
+static constexpr Scalar SatelliteMaxSpeed{ 2.5 };
 static constexpr auto FrameInterval = 50ms;
+static constexpr int MaxCatchUpTicks = 5;
 static constexpr auto IntroTextScrollInterval = 1s;
+static constexpr std::size_t RewindMemory = std::size_t{ 8 } << 20;
+static constexpr auto RewindDuration = 10s;
+static constexpr std::size_t RewindKeyframeInterval = 20;
+static constexpr std::size_t RewindBouncesPerFrame = 16;
+static constexpr std::size_t AutopilotCandidatesCount = 16;
+static constexpr std::size_t AutopilotRolloutsCount = 2;
+static constexpr auto AutopilotHorizon = 3s;
+static constexpr std::size_t AutopilotMinHorizonFrames = 5;
+static constexpr auto AutopilotBudget = 25ms;
 static constexpr int CharWidth = 2;
 static constexpr int CharHeight = 4;
 
+enum class Collisions {
+  None,
+  Bounce,
+  Merge,
+};
+
+// What happens to a new satellite when the universe is full
+enum class Overflow {
+  Reject,
+  RecycleOldest,
+};
+
+struct Settings
+{
+  std::uint64_t seed{};
+  std::size_t initialSatellitesCount{ InitialSatellitesCount };
+  // Cap on the number of satellites, raised to the initial number if lower, and allocated upfront,
+  // so that the game does not allocate and its frames do not slow down over time
+  std::size_t maxSatellitesCount{ MaxSatellitesCount };
+  Overflow overflow{ Overflow::Reject };
+  // Satellites disappear after this number of bounces on the shield, unless 0
+  std::uint32_t maxShieldBounces{};
+  // Number of satellites from which they are updated in parallel, on all the cores
+  std::size_t parallelSatellitesCount{ ParallelSatellitesCount };
+  bool indestructibleEarth{};
+  Collisions collisions{ Collisions::None };
+  // Satellites' velocities are expressed per FrameInterval, whatever the tick interval
+  std::chrono::steady_clock::duration tickInterval{ FrameInterval };
+  std::chrono::steady_clock::duration frameInterval{ FrameInterval };
+  // Bytes kept to rewind the game, allocated upfront, whose number of keyframes bounds how far it can go back
+  std::size_t rewindMemory{ RewindMemory };
+};
+
 }// namespace atw
@@ -0,0 +1,456 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "random.hpp"
+#include "grid.hpp"
+#include "handles.hpp"
+#include "painter.hpp"
+#include "satellite.hpp"
+#include "sectors.hpp"
+#include "shield.hpp"
+#include "utilities.hpp"
+#include "workers.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace atw {
+
+// Structure-of-arrays storage of all the satellites of the universe.
+// The batch update has the same results as Satellite::update.
+// Its moves and wall bounces are branchless loops which the compiler can vectorize:
+// a bounce only selects the new velocity, and the position is corrected arithmetically
+// (p + (-v - v) / 2 * s == p - v * s exactly), since conditional floating point operations prevent vectorization.
+// Then only the satellites in the sectors around the shield are checked against it, along their whole moves,
+// the sectors being widened by the longest move, so that no satellite goes through the shield, whatever its speed
+// and the tick interval. The Earth is also checked along the moves.
+// Above a threshold, the update runs over chunks of satellites on the workers, with the same results:
+// a satellite's move and bounces only depend on itself, and the chunks' hits are added up afterwards.
+// The positions before the last update are kept, to interpolate the drawing between two updates.
+// The satellites move in the arrays when others are erased, so they are also identified by stable handles,
+// and numbered by birth, to find the oldest one.
+class Constellation
+{
+  std::vector<Scalar> x{};
+  std::vector<Scalar> y{};
+  std::vector<Scalar> previousX{};
+  std::vector<Scalar> previousY{};
+  std::vector<Scalar> dx{};
+  std::vector<Scalar> dy{};
+  std::vector<std::uint8_t> flags{};
+  std::vector<std::uint32_t> shieldBounces{};
+  std::vector<std::uint64_t> births{};
+  std::vector<std::uint32_t> slots{};
+  Handles handles{};
+  std::uint64_t birthsCount{};
+  Sectors sectors{};
+  bool sectorsUpToDate{};
+  std::vector<std::size_t> chunkHits{};
+  // Bound of the squared speeds, which only the new satellites and the bounces between satellites raise,
+  // so that the longest move of an update, by which the sectors are widened, is known without going through them
+  Scalar maxSquaredSpeed{};
+
+  static constexpr std::size_t ChunkSize = 4096;
+
+  static constexpr std::uint8_t Red = 1;
+  static constexpr std::uint8_t Merged = 2;
+  static constexpr std::uint8_t Bounced = 4;
+  static constexpr Scalar SquaredCollisionDistance = (2 * SatelliteRadius) * (2 * SatelliteRadius);
+
+  static void
+    bounceOnWall(Scalar *position, Scalar *velocity, std::size_t count, Scalar limit, Scalar step) noexcept
+  {
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto v = velocity[i];
+      const auto moved = position[i] + v * step;
+      const auto newV = (moved >= limit) | (moved < Scalar{}) ? -v : v;
+      velocity[i] = newV;
+      position[i] = moved + (newV - v) * Scalar{ 0.5 } * step;
+    }
+  }
+
+  // Bounces the satellite back from the point where it touched the shield during its last move, if it did
+  bool bounceOnShield(const Shield &shield, std::size_t i) noexcept
+  {
+    const Point start{ previousX[i], previousY[i] };
+    const Offset move{ x[i] - start.x, y[i] - start.y };
+    const auto impact = shield.timeOfImpact(start, move);
+    if (!impact) return false;
+    dx[i] = -dx[i];
+    dy[i] = -dy[i];
+    const auto position = Satellite::bounceBack(start, move, *impact);
+    x[i] = position.x;
+    y[i] = position.y;
+    flags[i] |= Bounced;
+    ++shieldBounces[i];
+    return true;
+  }
+
+  std::size_t bounceOnShield(const Shield &shield)
+  {
+    std::size_t hits = 0;
+    sectors.forEachNearShield(shield.polarAngle(), [&](std::size_t i) {
+      if (!bounceOnShield(shield, i)) return;
+      if (Satellite::hitsEarth({ previousX[i], previousY[i] }, { x[i], y[i] })) sectors.addToEarthBand(i);
+      ++hits;
+    });
+    return hits;
+  }
+
+  // Checks the satellites in [first, last) against the whole shield, skipping those whose moves stayed inside or
+  // outside its band, which are not in its sectors either
+  std::size_t bounceOnShield(const Shield &shield, std::size_t first, std::size_t last) noexcept
+  {
+    static constexpr Scalar SquaredShieldBandInnerRadius =
+      Sectors::ShieldBandInnerRadius * Sectors::ShieldBandInnerRadius;
+    std::size_t hits = 0;
+    for (auto i = first; i < last; ++i) {
+      const Point start{ previousX[i], previousY[i] };
+      const Point end{ x[i], y[i] };
+      if (squaredDistance(start, EarthCenter) < SquaredShieldBandInnerRadius
+          && squaredDistance(end, EarthCenter) < SquaredShieldBandInnerRadius)
+        continue;
+      if (squaredDistance(EarthCenter, Segment{ start, end }) > Sectors::SquaredShieldBandOuterRadius) continue;
+      if (bounceOnShield(shield, i)) ++hits;
+    }
+    return hits;
+  }
+
+  void boundSpeed(Scalar vx, Scalar vy) noexcept { maxSquaredSpeed = std::max(maxSquaredSpeed, vx * vx + vy * vy); }
+
+  Handle addIdentity(std::size_t i)
+  {
+    shieldBounces.push_back(0);
+    births.push_back(birthsCount++);
+    const auto handle = handles.create(i);
+    slots.push_back(handle.slot);
+    return handle;
+  }
+
+  // Exchanges the velocity components along the line joining the centers, if the satellites get closer
+  void bounce(std::size_t i, std::size_t j, Offset diff, Scalar squaredDistance) noexcept
+  {
+    const auto k = ((dx[i] - dx[j]) * diff.dx + (dy[i] - dy[j]) * diff.dy) / squaredDistance;
+    if (k <= Scalar{}) return;
+    dx[i] -= k * diff.dx;
+    dy[i] -= k * diff.dy;
+    dx[j] += k * diff.dx;
+    dy[j] += k * diff.dy;
+    boundSpeed(dx[i], dy[i]);
+    boundSpeed(dx[j], dy[j]);
+  }
+
+  void merge(std::size_t i, std::size_t j) noexcept
+  {
+    x[i] = (x[i] + x[j]) / 2;
+    y[i] = (y[i] + y[j]) / 2;
+    dx[i] = (dx[i] + dx[j]) / 2;
+    dy[i] = (dy[i] + dy[j]) / 2;
+    flags[j] |= Merged;
+  }
+
+public:
+  std::size_t size() const noexcept { return x.size(); }
+  bool empty() const noexcept { return x.empty(); }
+
+  void reserve(std::size_t capacity)
+  {
+    reserveState(capacity);
+    sectors.reserve(capacity);
+    chunkHits.reserve(capacity / ChunkSize + 1);
+  }
+
+  // Only reserves the arrays copied by copyStateTo, for a constellation which only keeps a state, without updates
+  void reserveState(std::size_t capacity)
+  {
+    x.reserve(capacity);
+    y.reserve(capacity);
+    previousX.reserve(capacity);
+    previousY.reserve(capacity);
+    dx.reserve(capacity);
+    dy.reserve(capacity);
+    flags.reserve(capacity);
+    shieldBounces.reserve(capacity);
+    births.reserve(capacity);
+    slots.reserve(capacity);
+    handles.reserve(capacity);
+  }
+
+  Handle push_back(const Satellite &satellite)
+  {
+    const auto position = satellite.getPosition();
+    const auto velocity = satellite.getVelocity();
+    x.push_back(position.x);
+    y.push_back(position.y);
+    previousX.push_back(position.x);
+    previousY.push_back(position.y);
+    dx.push_back(velocity.dx);
+    dy.push_back(velocity.dy);
+    flags.push_back(satellite.isRed() ? Red : 0);
+    boundSpeed(velocity.dx, velocity.dy);
+    sectorsUpToDate = false;
+    return addIdentity(size() - 1);
+  }
+
+  // Appends count random satellites, drawn in batches into the arrays
+  void spawn(Random &random, std::size_t count)
+  {
+    const auto first = size();
+    x.resize(first + count);
+    y.resize(first + count);
+    dx.resize(first + count);
+    dy.resize(first + count);
+    const auto newX = std::span{ x }.subspan(first);
+    const auto newY = std::span{ y }.subspan(first);
+    randomPositions(random, newX, newY);
+    randomVelocities(random, newX, std::span{ dx }.subspan(first), std::span{ dy }.subspan(first));
+    previousX.insert(end(previousX), begin(newX), end(newX));
+    previousY.insert(end(previousY), begin(newY), end(newY));
+    flags.resize(first + count, 0);
+    sectorsUpToDate = false;
+    for (auto i = first; i < first + count; ++i) {
+      boundSpeed(dx[i], dy[i]);
+      addIdentity(i);
+    }
+  }
+
+  std::uint64_t hash(std::uint64_t seed) const noexcept
+  {
+    auto result = hashCombine(seed, std::uint64_t{ size() });
+    for (std::size_t i = 0; i < size(); ++i) {
+      result = hashCombine(result, x[i]);
+      result = hashCombine(result, y[i]);
+      result = hashCombine(result, dx[i]);
+      result = hashCombine(result, dy[i]);
+      result = hashCombine(result, std::uint64_t{ flags[i] });
+      result = hashCombine(result, std::uint64_t{ shieldBounces[i] });
+    }
+    return result;
+  }
+
+  // Hash of what is drawn of the satellites, which copyTo copies
+  std::uint64_t drawingHash(std::uint64_t seed) const noexcept
+  {
+    auto result = hashCombine(seed, std::uint64_t{ size() });
+    for (std::size_t i = 0; i < size(); ++i) {
+      result = hashCombine(result, x[i]);
+      result = hashCombine(result, y[i]);
+      result = hashCombine(result, previousX[i]);
+      result = hashCombine(result, previousY[i]);
+      result = hashCombine(result, std::uint64_t{ flags[i] });
+    }
+    return result;
+  }
+
+  Handle handle(std::size_t i) const noexcept { return handles.handleOf(slots[i]); }
+
+  // The index of the satellite, unless it was erased
+  std::optional<std::size_t> find(const Handle &handle) const noexcept { return handles.find(handle); }
+
+  std::uint32_t getShieldBounces(std::size_t i) const noexcept { return shieldBounces[i]; }
+
+  // Index of the satellite created first, among those remaining, if any
+  std::size_t oldest() const noexcept
+  {
+    return static_cast<std::size_t>(std::distance(begin(births), std::min_element(begin(births), end(births))));
+  }
+
+  // Copies the satellites, without the indexes, into arrays which keep their capacity from copy to copy
+  void copyTo(Constellation &other) const
+  {
+    other.x = x;
+    other.y = y;
+    other.previousX = previousX;
+    other.previousY = previousY;
+    other.dx = dx;
+    other.dy = dy;
+    other.flags = flags;
+    other.sectorsUpToDate = false;
+  }
+
+  // Copies the whole state of the satellites, identities included, into arrays which keep their capacity,
+  // but not the indexes, which the next update rebuilds
+  void copyStateTo(Constellation &other) const
+  {
+    copyTo(other);
+    other.shieldBounces = shieldBounces;
+    other.births = births;
+    other.slots = slots;
+    other.handles = handles;
+    other.birthsCount = birthsCount;
+    other.maxSquaredSpeed = maxSquaredSpeed;
+  }
+
+  // Memory used by a constellation reserved by reserveState for the given number of satellites
+  static constexpr std::size_t stateBytes(std::size_t count) noexcept
+  {
+    return count
+             * (6 * sizeof(Scalar) + sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t)
+                + Handles::BytesPerSlot)
+           + Sectors::FixedBytes;
+  }
+
+  // Appends the indices of the satellites which bounced on the shield during the last update
+  void appendBounced(std::vector<std::uint32_t> &indices) const
+  {
+    for (std::size_t i = 0; i < size(); ++i)
+      if ((flags[i] & Bounced) != 0) indices.push_back(static_cast<std::uint32_t>(i));
+  }
+
+  Satellite operator[](std::size_t i) const { return { { x[i], y[i] }, { dx[i], dy[i] }, (flags[i] & Red) != 0 }; }
+
+  // Returns the number of satellites which bounced on the shield
+  std::size_t update(const Shield &shield, Scalar step = Scalar{ 1 })
+  {
+    const auto count = size();
+
+    previousX = x;
+    previousY = y;
+
+    for (auto &flag : flags) flag = static_cast<std::uint8_t>((flag ^ Red) & ~Bounced);
+
+    bounceOnWall(x.data(), dx.data(), count, UniverseWidth, step);
+    bounceOnWall(y.data(), dy.data(), count, UniverseHeight, step);
+
+    sectors.update(x, y, math::sqrt(maxSquaredSpeed) * step);
+    sectorsUpToDate = true;
+
+    return bounceOnShield(shield);
+  }
+
+  // Same as update, over chunks of satellites taken by the workers.
+  // The sectors are indexed afterwards, from the final positions, since each chunk checks its satellites against the
+  // shield by itself.
+  std::size_t update(const Shield &shield, Scalar step, WorkerPool &workers)
+  {
+    const auto count = size();
+    const auto chunksCount = (count + ChunkSize - 1) / ChunkSize;
+    chunkHits.assign(chunksCount, 0);
+
+    workers.run(chunksCount, [&](std::size_t chunk) {
+      const auto first = chunk * ChunkSize;
+      const auto chunkSize = std::min(ChunkSize, count - first);
+      std::copy_n(x.data() + first, chunkSize, previousX.data() + first);
+      std::copy_n(y.data() + first, chunkSize, previousY.data() + first);
+      for (auto i = first; i < first + chunkSize; ++i)
+        flags[i] = static_cast<std::uint8_t>((flags[i] ^ Red) & ~Bounced);
+      bounceOnWall(x.data() + first, dx.data() + first, chunkSize, UniverseWidth, step);
+      bounceOnWall(y.data() + first, dy.data() + first, chunkSize, UniverseHeight, step);
+      chunkHits[chunk] = bounceOnShield(shield, first, first + chunkSize);
+    });
+
+    sectors.update(x, y, math::sqrt(maxSquaredSpeed) * step);
+    sectorsUpToDate = true;
+
+    return std::accumulate(begin(chunkHits), end(chunkHits), std::size_t{ 0 });
+  }
+
+  // Moves the last satellite at the place of the erased one
+  void erase(std::size_t i)
+  {
+    handles.release(slots[i]);
+    if (i != size() - 1) handles.move(slots.back(), i);
+    x[i] = x.back();
+    y[i] = y.back();
+    previousX[i] = previousX.back();
+    previousY[i] = previousY.back();
+    dx[i] = dx.back();
+    dy[i] = dy.back();
+    flags[i] = flags.back();
+    shieldBounces[i] = shieldBounces.back();
+    births[i] = births.back();
+    slots[i] = slots.back();
+    x.pop_back();
+    y.pop_back();
+    previousX.pop_back();
+    previousY.pop_back();
+    dx.pop_back();
+    dy.pop_back();
+    flags.pop_back();
+    shieldBounces.pop_back();
+    births.pop_back();
+    slots.pop_back();
+    sectorsUpToDate = false;
+  }
+
+  // Erases the satellites which bounced on the shield at least the given number of times, and returns their number
+  std::size_t despawn(std::uint32_t maxShieldBounces)
+  {
+    std::size_t count = 0;
+    for (auto i = size(); i-- > 0;) {
+      if (shieldBounces[i] < maxShieldBounces) continue;
+      erase(i);
+      ++count;
+    }
+    return count;
+  }
+
+  // Elastic collisions between satellites, or merges of colliding satellites
+  void collide(Grid &grid, Collisions collisions)
+  {
+    if (collisions == Collisions::None) return;
+
+    grid.update(x, y);
+
+    for (std::size_t i = 0; i < size(); ++i) {
+      if ((flags[i] & Merged) != 0) continue;
+      grid.forEachNeighbour(i, [&](std::size_t j) {
+        if ((flags[j] & Merged) != 0) return;
+        const auto diffX = x[j] - x[i];
+        const auto diffY = y[j] - y[i];
+        const auto squaredDistance = diffX * diffX + diffY * diffY;
+        if (squaredDistance > SquaredCollisionDistance || squaredDistance <= Scalar{}) return;
+        if (collisions == Collisions::Bounce)
+          bounce(i, j, { diffX, diffY }, squaredDistance);
+        else
+          merge(i, j);
+      });
+    }
+
+    if (collisions != Collisions::Merge) return;
+    for (auto i = size(); i-- > 0;) {
+      if ((flags[i] & Merged) == 0) continue;
+      grid.erase(i);
+      erase(i);
+    }
+  }
+
+  // Whether a satellite touched the Earth during its last move.
+  // Only checks the Earth's band, unless satellites were added or removed since the last update
+  bool anyNearEarth() const noexcept
+  {
+    if (sectorsUpToDate) {
+      const auto &earthBand = sectors.getEarthBand();
+      return std::any_of(begin(earthBand), end(earthBand), [&](std::size_t i) {
+        return Satellite::hitsEarth({ previousX[i], previousY[i] }, { x[i], y[i] });
+      });
+    }
+
+    const auto *px = x.data();
+    const auto *py = y.data();
+    const auto *ppx = previousX.data();
+    const auto *ppy = previousY.data();
+    bool near = false;
+    for (std::size_t i = 0, count = size(); i < count; ++i)
+      near |= Satellite::hitsEarth({ ppx[i], ppy[i] }, { px[i], py[i] });
+    return near;
+  }
+
+  // Draws the satellites at the given fraction of the way from their previous positions to their current ones
+  void draw(Painter &painter, Scalar interpolation = Scalar{ 1 }) const
+  {
+    for (std::size_t i = 0; i < size(); ++i) {
+      const Point position{ previousX[i] + (x[i] - previousX[i]) * interpolation,
+        previousY[i] + (y[i] - previousY[i]) * interpolation };
+      painter.touch(Box::around(static_cast<int>(position.x), static_cast<int>(position.y), SatelliteRadius + 1));
+      Satellite{ position, {}, (flags[i] & Red) != 0 }.draw(painter.getCanvas());
+    }
+  }
+};
+
+}// namespace atw
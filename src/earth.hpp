@@ -1,14 +1,54 @@
 
 #pragma once
 
-#include "satellite.hpp"
 #include "configuration.hpp"
+#include "constellation.hpp"
+#include "painter.hpp"
+#include "satellite.hpp"
+#include "stamps.hpp"
 #include "utilities.hpp"
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace atw {
 
+enum class BackgroundLayer : std::uint8_t {
+  Space,
+  Earth,
+  Orbit,
+};
+
+static constexpr Box BackgroundBox =
+  Box::around(static_cast<int>(EarthCenter.x), static_cast<int>(EarthCenter.y), ShieldRadius + 1);
+static constexpr int BackgroundWidth = BackgroundBox.right - BackgroundBox.left + 1;
+static constexpr int BackgroundHeight = BackgroundBox.bottom - BackgroundBox.top + 1;
+
+constexpr std::size_t backgroundIndex(int x, int y) noexcept
+{
+  return static_cast<std::size_t>((y - BackgroundBox.top) * BackgroundWidth + x - BackgroundBox.left);
+}
+
+// The Earth's disk and the shield's orbit, rasterized once, the Earth's color being chosen when drawing
+static constexpr auto Background = [] {
+  std::array<BackgroundLayer, static_cast<std::size_t>(BackgroundWidth * BackgroundHeight)> layer{};
+  for (int y = BackgroundBox.top; y <= BackgroundBox.bottom; ++y) {
+    for (int x = BackgroundBox.left; x <= BackgroundBox.right; ++x) {
+      const auto dx = x - static_cast<int>(EarthCenter.x);
+      const auto dy = y - static_cast<int>(EarthCenter.y);
+      if (isInCircle(dx, dy, EarthRadius, true))
+        layer[backgroundIndex(x, y)] = BackgroundLayer::Earth;
+      else if (isInCircle(dx, dy, ShieldRadius, false))
+        layer[backgroundIndex(x, y)] = BackgroundLayer::Orbit;
+    }
+  }
+  return layer;
+}();
+
 class Earth
 {
   bool is_destroyed{};
@@ -22,18 +62,43 @@ public:
     return !is_destroyed;
   }
 
-  void draw(ftxui::Canvas &canvas) const
+  bool update(const Constellation &satellites)
   {
-    canvas.DrawBlockCircleFilled(static_cast<int>(EarthCenter.x),
-      static_cast<int>(EarthCenter.y),
-      EarthRadius,
-      is_destroyed ? ftxui::Color::Red : ftxui::Color::Blue);
-    canvas.DrawPointCircle(static_cast<int>(EarthCenter.x), static_cast<int>(EarthCenter.y), ShieldRadius);
-    if (is_destroyed)
-      canvas.DrawText(static_cast<int>(EarthCenter.x) - 20,
-        static_cast<int>(EarthCenter.y),
-        "BOOOOOOOOOOOOOOOOOOOOOOM",
-        ftxui::Color::Red);
+    if (is_destroyed) return false;
+    is_destroyed = satellites.anyNearEarth();
+    return !is_destroyed;
+  }
+
+  // Draws the Earth, the shield's orbit and the explosion, only in the given box of the canvas
+  void draw(ftxui::Canvas &canvas, const Box &box) const
+  {
+    static constexpr int TextX = static_cast<int>(EarthCenter.x) - 20;
+    static constexpr int TextY = static_cast<int>(EarthCenter.y);
+    static constexpr std::string_view Text = "BOOOOOOOOOOOOOOOOOOOOOOM";
+    static constexpr Box TextBox =
+      Box{ TextX, TextY, TextX + static_cast<int>(Text.size()) * CharWidth - 1, TextY }.cells();
+    // Built once, rather than at each frame of the end
+    static const std::string DrawnText{ Text };
+
+    const auto color = is_destroyed ? ftxui::Color::Red : ftxui::Color::Blue;
+    const auto area = box.intersection(BackgroundBox);
+    for (int y = area.top; y <= area.bottom; ++y) {
+      for (int x = area.left; x <= area.right; ++x) {
+        switch (Background[backgroundIndex(x, y)]) {
+        case BackgroundLayer::Earth:
+          canvas.DrawBlock(x, y, true, color);
+          break;
+        case BackgroundLayer::Orbit:
+          canvas.DrawPoint(x, y, true);
+          break;
+        case BackgroundLayer::Space:
+        default:
+          break;
+        }
+      }
+    }
+    if (is_destroyed && !box.intersection(TextBox).empty())
+      canvas.DrawText(TextX, TextY, DrawnText, ftxui::Color::Red);
   }
 };
 
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "configuration.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace atw {
+
+// Uniform grid covering the universe, with cells as large as the collision distance between two satellites,
+// so that a satellite can only collide with the satellites of its own cell and of the 8 neighbouring cells.
+// Each cell links its satellites in an intrusive list, which is only updated for the satellites changing of cell.
+class Grid
+{
+public:
+  static constexpr int CellSize = 2 * SatelliteRadius;
+  static constexpr int Columns = (UniverseWidth + CellSize - 1) / CellSize;
+  static constexpr int Rows = (UniverseHeight + CellSize - 1) / CellSize;
+
+private:
+  static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+
+  std::vector<std::size_t> heads = std::vector<std::size_t>(Columns * Rows, None);
+  std::vector<std::size_t> cells{};
+  std::vector<std::size_t> next{};
+  std::vector<std::size_t> previous{};
+
+  static int column(Scalar x) noexcept { return std::clamp(static_cast<int>(x) / CellSize, 0, Columns - 1); }
+  static int row(Scalar y) noexcept { return std::clamp(static_cast<int>(y) / CellSize, 0, Rows - 1); }
+  static std::size_t cellAt(int c, int r) noexcept { return static_cast<std::size_t>(r * Columns + c); }
+  static std::size_t cellOf(Scalar x, Scalar y) noexcept { return cellAt(column(x), row(y)); }
+
+  void link(std::size_t i, std::size_t cell) noexcept
+  {
+    cells[i] = cell;
+    previous[i] = None;
+    next[i] = heads[cell];
+    if (next[i] != None) previous[next[i]] = i;
+    heads[cell] = i;
+  }
+
+  void unlink(std::size_t i) noexcept
+  {
+    if (previous[i] != None)
+      next[previous[i]] = next[i];
+    else
+      heads[cells[i]] = next[i];
+    if (next[i] != None) previous[next[i]] = previous[i];
+  }
+
+public:
+  // Memory used by the grid of the given number of satellites
+  static constexpr std::size_t stateBytes(std::size_t count) noexcept
+  {
+    return (Columns * Rows + 3 * count) * sizeof(std::size_t);
+  }
+
+  std::size_t size() const noexcept { return cells.size(); }
+
+  void reserve(std::size_t capacity)
+  {
+    cells.reserve(capacity);
+    next.reserve(capacity);
+    previous.reserve(capacity);
+  }
+
+  // The satellites erased since the last update without erasing them from the grid, the last ones having been moved
+  // at their places, are unlinked, and the moved ones are relinked from their positions
+  void update(std::span<const Scalar> x, std::span<const Scalar> y)
+  {
+    for (auto i = x.size(); i < size(); ++i) unlink(i);
+    const auto linkedCount = std::min(size(), x.size());
+    for (std::size_t i = 0; i < linkedCount; ++i) {
+      const auto cell = cellOf(x[i], y[i]);
+      if (cell == cells[i]) continue;
+      unlink(i);
+      link(i, cell);
+    }
+
+    cells.resize(x.size());
+    next.resize(x.size());
+    previous.resize(x.size());
+    for (auto i = linkedCount; i < x.size(); ++i) link(i, cellOf(x[i], y[i]));
+  }
+
+  // Moves the last satellite at the place of the erased one, like Constellation::erase
+  void erase(std::size_t i) noexcept
+  {
+    const auto last = size() - 1;
+    unlink(i);
+    if (i != last) {
+      unlink(last);
+      link(i, cells[last]);
+    }
+    cells.pop_back();
+    next.pop_back();
+    previous.pop_back();
+  }
+
+  // Calls f(j) for the satellites j which may collide with satellite i, so that each pair is visited once:
+  // the satellites after i in its own cell, and all the satellites of the 4 following neighbouring cells
+  template<typename F> void forEachNeighbour(std::size_t i, F &&f) const
+  {
+    for (auto j = next[i]; j != None; j = next[j]) f(j);
+
+    const auto c = static_cast<int>(cells[i] % Columns);
+    const auto r = static_cast<int>(cells[i] / Columns);
+    const auto visit = [&](int nc, int nr) {
+      if (nc < 0 || nc >= Columns || nr >= Rows) return;
+      for (auto j = heads[cellAt(nc, nr)]; j != None; j = next[j]) f(j);
+    };
+    visit(c + 1, r);
+    visit(c - 1, r + 1);
+    visit(c, r + 1);
+    visit(c + 1, r + 1);
+  }
+};
+
+}// namespace atw
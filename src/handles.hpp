@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace atw {
+
+// Stable identifier of an element whose index changes: the slot of the handle, and the generation of the slot,
+// which is incremented when the element is erased, so that an old handle is not mistaken for the slot's new occupant
+struct Handle
+{
+  std::uint32_t slot{};
+  std::uint32_t generation{};
+
+  bool operator==(const Handle &) const = default;
+};
+
+// Slots of the handles, pointing at the indices of the elements in their dense arrays.
+// The slots of the erased elements are kept in a free list, and reused first,
+// so that the slots never outnumber the elements alive at the same time.
+class Handles
+{
+  std::vector<std::uint32_t> indices{};
+  std::vector<std::uint32_t> generations{};
+  std::vector<std::uint32_t> freeSlots{};
+
+public:
+  static constexpr std::size_t BytesPerSlot = 3 * sizeof(std::uint32_t);
+
+  void reserve(std::size_t capacity)
+  {
+    indices.reserve(capacity);
+    generations.reserve(capacity);
+    freeSlots.reserve(capacity);
+  }
+
+  Handle create(std::size_t index)
+  {
+    if (freeSlots.empty()) {
+      indices.push_back(static_cast<std::uint32_t>(index));
+      generations.push_back(0);
+      return { static_cast<std::uint32_t>(indices.size() - 1), 0 };
+    }
+    const auto slot = freeSlots.back();
+    freeSlots.pop_back();
+    indices[slot] = static_cast<std::uint32_t>(index);
+    return { slot, generations[slot] };
+  }
+
+  // The element of the slot moved to the given index
+  void move(std::uint32_t slot, std::size_t index) noexcept { indices[slot] = static_cast<std::uint32_t>(index); }
+
+  void release(std::uint32_t slot)
+  {
+    ++generations[slot];
+    freeSlots.push_back(slot);
+  }
+
+  // Empty if the element was erased
+  std::optional<std::size_t> find(const Handle &handle) const noexcept
+  {
+    if (handle.slot >= generations.size() || generations[handle.slot] != handle.generation) return std::nullopt;
+    return indices[handle.slot];
+  }
+
+  Handle handleOf(std::uint32_t slot) const noexcept { return { slot, generations[slot] }; }
+};
+
+}// namespace atw
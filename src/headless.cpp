@@ -0,0 +1,139 @@
+#include "aroundtheworld.hpp"
+#include "autopilot.hpp"
+#include "batch.hpp"
+#include "configuration.hpp"
+#include "profiler.hpp"
+#include "recording.hpp"
+#include "satellite.hpp"
+#include "universe.hpp"
+#include "utilities.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace atw {
+
+// Moves the mouse around the Earth, so that the shield keeps sweeping the orbit
+static Event scriptedMouseEvent(std::size_t frame)
+{
+  static constexpr Scalar MouseAngleStep = ShieldAngleStep / Scalar{ 4 };
+  const auto angle = toScalar(static_cast<double>(frame)) * MouseAngleStep;
+  return {
+    EventType::Mouse,
+    transpose(Point{ ShieldRadius * math::cos(angle), ShieldRadius * math::sin(angle) }, CenterOffset),
+  };
+}
+
+static std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds> &durations, double ratio)
+{
+  if (durations.empty()) return {};
+  const auto index = static_cast<std::size_t>(ratio * static_cast<double>(durations.size() - 1));
+  std::nth_element(begin(durations), std::next(begin(durations), static_cast<std::ptrdiff_t>(index)), end(durations));
+  return durations[index];
+}
+
+void playHeadless(const Settings &settings, const HeadlessOptions &options)
+{
+  auto now = std::chrono::steady_clock::time_point{};
+  Universe universe{ now, settings };
+  universe.update(now, { EventType::Start });
+  std::optional<Autopilot> autopilot{};
+  if (options.autopilot) autopilot.emplace(universe);
+
+  std::vector<std::chrono::nanoseconds> durations{};
+  durations.reserve(options.frames);
+
+  if (!options.tracePath.empty()) profiler.enable(true);
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t frame = 0; frame < options.frames && universe.getState() == State::Play; ++frame) {
+    now += settings.frameInterval;
+    const auto frameStart = std::chrono::steady_clock::now();
+    {
+      const PhaseTimer timer{ Phase::Update };
+      universe.update(now, autopilot ? autopilot->plan(universe) : scriptedMouseEvent(frame));
+      universe.update(now, { EventType::Frame });
+    }
+    durations.push_back(std::chrono::steady_clock::now() - frameStart);
+  }
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+  if (!options.tracePath.empty()) profiler.writeTrace(options.tracePath);
+
+  const auto frames = durations.size();
+  fmt::print("seed: {}, frames: {}, satellites: {}, points: {}{}\n",
+    settings.seed,
+    frames,
+    universe.getSatellites().size(),
+    universe.getPoints(),
+    universe.getState() == State::End ? ", earth destroyed" : "");
+  if (frames == 0) return;
+  fmt::print("frames/s: {:.0f}, ns/frame: {:.0f}\n",
+    static_cast<double>(frames) / elapsed.count(),
+    elapsed.count() * 1e9 / static_cast<double>(frames));
+  fmt::print("update p50: {} ns, p99: {} ns, p999: {} ns\n",
+    percentile(durations, 0.5).count(),
+    percentile(durations, 0.99).count(),
+    percentile(durations, 0.999).count());
+  if (autopilot) fmt::print("autopilot horizon: {} frames\n", autopilot->getHorizon());
+}
+
+void playBatch(const Settings &settings, const BatchOptions &options)
+{
+  const auto sweep = [](const Universe &, std::size_t frame) { return scriptedMouseEvent(frame); };
+  const auto start = std::chrono::steady_clock::now();
+  const auto result = runBatch(settings, options.universesCount, options.frames, sweep);
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+  fmt::print("universes: {}, seeds: {} to {}, earth destroyed: {}\n",
+    result.universes.size(),
+    settings.seed,
+    settings.seed + options.universesCount - 1,
+    result.destroyedCount);
+  if (result.universes.empty()) return;
+  fmt::print("frames: mean {:.1f}, min {}, median {}, max {}\n",
+    result.frames.mean,
+    result.frames.min,
+    result.frames.median,
+    result.frames.max);
+  fmt::print("points: mean {:.1f}, min {}, median {}, max {}\n",
+    result.points.mean,
+    result.points.min,
+    result.points.median,
+    result.points.max);
+  fmt::print("threads: {}, universes/s: {:.1f}, frames/s: {:.0f}\n",
+    workerPool().getThreadsCount() + 1,
+    static_cast<double>(result.universes.size()) / elapsed.count(),
+    result.frames.mean * static_cast<double>(result.universes.size()) / elapsed.count());
+}
+
+bool replay(const std::string &recordPath)
+{
+  std::ifstream recordFile{ recordPath, std::ios::binary };
+  if (!recordFile) throw std::runtime_error(fmt::format("cannot read the recording '{}'", recordPath));
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto result = replay(recordFile);
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+  fmt::print("events: {}, points: {}{}\n",
+    result.eventsCount,
+    result.points,
+    result.state == State::End ? ", earth destroyed" : "");
+  fmt::print("replayed in {:.3f} ms\n", elapsed.count() * 1e3);
+  if (!result.recordedStateHash) {
+    fmt::print("state hash: {:016x} (the recording was interrupted, nothing to check)\n", result.stateHash);
+    return true;
+  }
+  const auto same = result.stateHash == *result.recordedStateHash;
+  fmt::print("state hash: {:016x}, recorded: {:016x}, {}\n",
+    result.stateHash,
+    *result.recordedStateHash,
+    same ? "same" : "DIFFERENT");
+  return same;
+}
+
+}// namespace atw
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "universe.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace atw {
+
+// Lock-free queue of the events, from the input thread to the simulation thread.
+// The indices only grow: the queue is full when the producer is a whole ring ahead of the consumer,
+// in which case the new events are dropped rather than blocking the input.
+class EventQueue
+{
+public:
+  static constexpr std::size_t Capacity = 1024;
+
+private:
+  std::array<Event, Capacity> events{};
+  // Next event to pop, only written by the consumer
+  alignas(64) std::atomic<std::size_t> head{};
+  // Next event to push, only written by the producer
+  alignas(64) std::atomic<std::size_t> tail{};
+
+public:
+  // Returns false if the queue is full
+  bool push(const Event &e) noexcept
+  {
+    const auto t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+    events[t % Capacity] = e;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Calls f(event) for the events pushed so far, in order, and returns their number
+  template<typename F> std::size_t drain(F &&f)
+  {
+    auto h = head.load(std::memory_order_relaxed);
+    const auto t = tail.load(std::memory_order_acquire);
+    const auto count = t - h;
+    for (; h != t; ++h) f(events[h % Capacity]);
+    head.store(h, std::memory_order_release);
+    return count;
+  }
+};
+
+// Input stage between the input thread and the simulation.
+// Fast mouse motion sends hundreds of moves per frame, and only the last position of the shield matters:
+// the moves are coalesced as they are pushed, in a slot holding the last one, so that they never fill the queue,
+// which only holds the other events. Before such an event, the pending move is pushed in the queue, so that each
+// simulation step applies the events in order, with consecutive mouse moves collapsed to the last one.
+// The slot is a triple buffer: the input thread writes the move in its own buffer, then exchanges it with the middle
+// one, which the simulation thread exchanges with its own buffer when it holds a new move.
+class Input
+{
+  struct Move
+  {
+    Point position{};
+    // Number of events pushed in the queue before the move, so that it is applied after them
+    std::uint64_t queuedCount{};
+  };
+
+  static constexpr std::uint32_t Fresh = 4;
+  static constexpr std::uint32_t IndexMask = Fresh - 1;
+
+  EventQueue queue{};
+  std::array<Move, 3> moves{};
+  alignas(64) std::atomic<std::uint32_t> middle{ 1 };
+  // Only used by the input thread
+  alignas(64) std::uint32_t back{ 0 };
+  std::uint64_t queuedCount{};
+  std::atomic<std::uint64_t> receivedCount{};
+  // Only used by the simulation thread
+  alignas(64) std::uint32_t front{ 2 };
+  std::uint64_t drainedCount{};
+  std::atomic<std::uint64_t> appliedCount{};
+
+  void enqueue(const Event &e) noexcept
+  {
+    if (queue.push(e)) ++queuedCount;
+  }
+
+  // Called by the simulation thread: the last move pushed since the previous call, if any
+  std::optional<Move> takeMove() noexcept
+  {
+    if ((middle.load(std::memory_order_relaxed) & Fresh) == 0) return std::nullopt;
+    const auto taken = middle.exchange(front, std::memory_order_acq_rel);
+    front = taken & IndexMask;
+    if ((taken & Fresh) == 0) return std::nullopt;
+    return moves[front];
+  }
+
+public:
+  // Called by the input thread
+  void push(const Event &e) noexcept
+  {
+    receivedCount.fetch_add(1, std::memory_order_relaxed);
+    if (e.type == EventType::Mouse) {
+      moves[back] = { e.mouse, queuedCount };
+      back = middle.exchange(back | Fresh, std::memory_order_acq_rel) & IndexMask;
+      return;
+    }
+    // Takes back the pending move, unless the simulation thread already took it
+    const auto pending = middle.exchange(back, std::memory_order_acq_rel);
+    back = pending & IndexMask;
+    if ((pending & Fresh) != 0) enqueue({ EventType::Mouse, moves[back].position });
+    enqueue(e);
+  }
+
+  // Called by the simulation thread: calls f(event) for the coalesced events, and returns their number
+  template<typename F> std::size_t apply(F &&f)
+  {
+    std::size_t count = 0;
+    const auto applyEvent = [&](const Event &e) {
+      f(e);
+      ++count;
+    };
+    // Taken before draining the queue, so that the events pushed before the move are all visible
+    auto move = takeMove();
+    queue.drain([&](const Event &e) {
+      if (move && move->queuedCount == drainedCount) {
+        applyEvent({ EventType::Mouse, move->position });
+        move.reset();
+      }
+      ++drainedCount;
+      applyEvent(e);
+    });
+    if (move) applyEvent({ EventType::Mouse, move->position });
+    appliedCount.fetch_add(count, std::memory_order_relaxed);
+    return count;
+  }
+
+  std::uint64_t getReceivedCount() const noexcept { return receivedCount.load(std::memory_order_relaxed); }
+  std::uint64_t getAppliedCount() const noexcept { return appliedCount.load(std::memory_order_relaxed); }
+};
+
+}// namespace atw
@@ -1,11 +1,38 @@
-
 #include "aroundtheworld.hpp"
 #include <docopt/docopt.h>
 #include <fmt/format.h>
 #include <internal_use_only/config.hpp>
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <random>
+#include <stdexcept>
 #include <string>
 
+static atw::Collisions parseCollisions(const std::string &mode)
+{
+  if (mode == "bounce") return atw::Collisions::Bounce;
+  if (mode == "merge") return atw::Collisions::Merge;
+  if (mode == "none") return atw::Collisions::None;
+  throw std::invalid_argument(fmt::format("unknown collisions mode '{}'", mode));
+}
+
+static atw::Overflow parseOverflow(const std::string &policy)
+{
+  if (policy == "reject") return atw::Overflow::Reject;
+  if (policy == "recycle") return atw::Overflow::RecycleOldest;
+  throw std::invalid_argument(fmt::format("unknown overflow policy '{}'", policy));
+}
+
+static std::chrono::steady_clock::duration parseRate(long hertz)
+{
+  if (hertz <= 0) throw std::invalid_argument(fmt::format("invalid rate {} Hz", hertz));
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / static_cast<double>(hertz)));
+}
+
+static std::string optionalPath(const docopt::value &path) { return path ? path.asString() : std::string{}; }
+
 int main(int argc, const char **argv)
 {
   try {
@@ -13,12 +40,33 @@ int main(int argc, const char **argv)
       R"(aroundtheworld
 
     Usage:
-          aroundtheworld
+          aroundtheworld [--seed=S] [--record=FILE] [--trace=FILE] [--rewind-memory=MB] [--autopilot] [--collisions=MODE] [--max-satellites=N] [--overflow=POLICY] [--wear=B] [--tick-rate=HZ] [--frame-rate=HZ]
+          aroundtheworld --headless [--frames=N] [--satellites=M] [--seed=S] [--trace=FILE] [--immortal] [--autopilot] [--parallel-from=N] [--collisions=MODE] [--max-satellites=N] [--overflow=POLICY] [--wear=B] [--tick-rate=HZ] [--frame-rate=HZ]
+          aroundtheworld --batch=N [--frames=N] [--satellites=M] [--seed=S] [--collisions=MODE] [--max-satellites=N] [--overflow=POLICY] [--wear=B] [--tick-rate=HZ] [--frame-rate=HZ]
+          aroundtheworld --replay=FILE
           aroundtheworld (-h | --help)
           aroundtheworld --version
  Options:
-          -h --help     Show this screen.
-          --version     Show version.
+          -h --help           Show this screen.
+          --version           Show version.
+          --headless          Simulate without terminal, as fast as possible, and report timings.
+          --batch=N           Simulate N universes on all the cores, with successive seeds, and report their statistics.
+          --frames=N          Number of simulated frames, of each universe with --batch [default: 10000].
+          --satellites=M      Initial number of satellites [default: 3].
+          --seed=S            Seed of the random generator (random if omitted).
+          --record=FILE       Record the game's events into FILE, to replay them with --replay.
+          --replay=FILE       Replay the recorded game as fast as possible, and check its final state.
+          --rewind-memory=MB  Memory kept to rewind the game by 10 seconds with [BACKSPACE] [default: 8].
+          --trace=FILE        Write the durations of the frames' phases into FILE, as Chrome trace events.
+          --autopilot         Steer the shield by simulating its moves a few seconds ahead, instead of the player.
+          --immortal          Let the Earth survive impacts (for soak tests).
+          --parallel-from=N   Number of satellites from which they are updated on all the cores [default: 20000].
+          --collisions=MODE   Collisions between satellites: none, bounce or merge [default: none].
+          --max-satellites=N  Maximum number of satellites, raised to the initial number if lower [default: 1000].
+          --overflow=POLICY   What to do with new satellites when full: reject or recycle the oldest [default: reject].
+          --wear=B            Remove the satellites after B bounces on the shield, unless 0 [default: 0].
+          --tick-rate=HZ      Simulation steps per second [default: 20].
+          --frame-rate=HZ     Rendered frames per second [default: 20].
 )";
 
     std::map<std::string, docopt::value> args = docopt::docopt(USAGE,
@@ -29,7 +77,42 @@ int main(int argc, const char **argv)
         try_game_jam::cmake::project_version));// version string, acquired
                                                // from config.hpp via CMake
 
-    atw::play();
+    if (args["--replay"]) return atw::replay(args["--replay"].asString()) ? 0 : 1;
+
+    atw::Settings settings{
+      .seed = args["--seed"] ? static_cast<std::uint64_t>(args["--seed"].asLong()) : std::random_device{}(),
+      .maxSatellitesCount = static_cast<std::size_t>(args["--max-satellites"].asLong()),
+      .overflow = parseOverflow(args["--overflow"].asString()),
+      .maxShieldBounces = static_cast<std::uint32_t>(args["--wear"].asLong()),
+      .collisions = parseCollisions(args["--collisions"].asString()),
+      .tickInterval = parseRate(args["--tick-rate"].asLong()),
+      .frameInterval = parseRate(args["--frame-rate"].asLong()),
+    };
+
+    if (args["--batch"]) {
+      settings.initialSatellitesCount = static_cast<std::size_t>(args["--satellites"].asLong());
+      atw::playBatch(settings,
+        { .universesCount = static_cast<std::size_t>(args["--batch"].asLong()),
+          .frames = static_cast<std::size_t>(args["--frames"].asLong()) });
+      return 0;
+    }
+
+    if (args["--headless"].asBool()) {
+      settings.initialSatellitesCount = static_cast<std::size_t>(args["--satellites"].asLong());
+      settings.indestructibleEarth = args["--immortal"].asBool();
+      settings.parallelSatellitesCount = static_cast<std::size_t>(args["--parallel-from"].asLong());
+      atw::playHeadless(settings,
+        { .frames = static_cast<std::size_t>(args["--frames"].asLong()),
+          .tracePath = optionalPath(args["--trace"]),
+          .autopilot = args["--autopilot"].asBool() });
+      return 0;
+    }
+
+    settings.rewindMemory = static_cast<std::size_t>(args["--rewind-memory"].asLong()) << 20;
+    atw::play(settings,
+      { .recordPath = optionalPath(args["--record"]),
+        .tracePath = optionalPath(args["--trace"]),
+        .autopilot = args["--autopilot"].asBool() });
   } catch (const std::exception &e) {
     fmt::print("Unhandled exception in main: {}", e.what());
   }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "configuration.hpp"
+#include <ftxui/dom/canvas.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace atw {
+
+// Rectangle of canvas dots, bounds included
+struct Box
+{
+  int left{};
+  int top{};
+  int right{};
+  int bottom{};
+
+  constexpr bool empty() const noexcept { return left > right || top > bottom; }
+
+  constexpr Box intersection(const Box &other) const noexcept
+  {
+    return { std::max(left, other.left),
+      std::max(top, other.top),
+      std::min(right, other.right),
+      std::min(bottom, other.bottom) };
+  }
+
+  // Smallest box of whole canvas cells (2 dots wide, 4 dots high) containing this box
+  constexpr Box cells() const noexcept { return { left & ~1, top & ~3, right | 1, bottom | 3 }; }
+
+  static constexpr Box around(int x, int y, int radius) noexcept
+  {
+    return { x - radius, y - radius, x + radius, y + radius };
+  }
+};
+
+static constexpr Box CanvasBox{ 0, 0, UniverseWidth - 1, UniverseHeight - 1 };
+
+// Keeps a canvas from frame to frame, and only repaints the cells touched by the moving shapes:
+// each frame, the cells touched in the previous frame are cleared and their background is restored,
+// then the moving shapes are drawn again, touching the cells to restore in the next frame.
+class Painter
+{
+  ftxui::Canvas canvas{ UniverseWidth, UniverseHeight };
+  std::vector<Box> touchedBoxes{};
+  int scene{ -1 };
+  std::string text{};
+
+public:
+  ftxui::Canvas &getCanvas() noexcept { return canvas; }
+  const ftxui::Canvas &getCanvas() const noexcept { return canvas; }
+  // Reused to build the texts to draw
+  std::string &getText() noexcept { return text; }
+
+  void clear()
+  {
+    canvas = ftxui::Canvas(UniverseWidth, UniverseHeight);
+    touchedBoxes.clear();
+    scene = -1;
+  }
+
+  // Returns true if the canvas was cleared, because the scene changed and must be entirely drawn
+  bool beginScene(int newScene)
+  {
+    if (newScene == scene) return false;
+    clear();
+    scene = newScene;
+    return true;
+  }
+
+  // Marks the cells of a moving shape, to be restored before the next frame
+  void touch(const Box &box)
+  {
+    const auto cells = box.cells().intersection(CanvasBox);
+    if (!cells.empty()) touchedBoxes.push_back(cells);
+  }
+
+  // Clears the cells touched since the last restore, then calls drawBackground(box) for each of their boxes
+  template<typename F> void restore(F &&drawBackground)
+  {
+    for (const auto &box : touchedBoxes)
+      for (int y = box.top; y <= box.bottom; y += 2)
+        for (int x = box.left; x <= box.right; ++x) canvas.DrawBlock(x, y, false);
+    for (const auto &box : touchedBoxes) drawBackground(box);
+    touchedBoxes.clear();
+  }
+};
+
+}// namespace atw
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace atw {
+
+enum class Phase : std::uint8_t {
+  Update,
+  Earth,
+  Draw,
+  Render,
+  Count,
+};
+
+static constexpr std::array<std::string_view, static_cast<std::size_t>(Phase::Count)> PhaseNames{
+  "update",
+  "earth",
+  "draw",
+  "render",
+};
+
+// Durations of the phases of the frames, kept in a lock-free ring buffer of the last samples.
+// Any thread can record samples: each one takes a slot by incrementing the head, and publishes it with a sequence
+// number, so that a reader skips the slots being written, or overwritten after it lagged a whole ring behind.
+// When disabled, a phase's timer costs a relaxed load of the flag, and a predictable branch in its constructor and
+// in its destructor.
+class Profiler
+{
+public:
+  static constexpr std::size_t Capacity = 1 << 16;
+
+  struct Sample
+  {
+    Phase phase{};
+    std::uint32_t thread{};
+    std::chrono::steady_clock::time_point start{};
+    std::chrono::steady_clock::duration duration{};
+  };
+
+  struct PhaseStatistics
+  {
+    std::size_t count{};
+    std::chrono::steady_clock::duration average{};
+    std::chrono::steady_clock::duration p99{};
+  };
+
+  using Statistics = std::array<PhaseStatistics, static_cast<std::size_t>(Phase::Count)>;
+
+private:
+  struct Slot
+  {
+    // Index of the sample plus one, once it is written
+    std::atomic<std::uint64_t> sequence{};
+    std::atomic<std::uint32_t> phaseAndThread{};
+    std::atomic<std::chrono::steady_clock::rep> start{};
+    std::atomic<std::chrono::steady_clock::rep> duration{};
+  };
+
+  std::atomic<bool> enabled{};
+  std::atomic<std::uint64_t> head{};
+  std::array<Slot, Capacity> slots{};
+
+  static std::uint32_t threadIndex() noexcept
+  {
+    static std::atomic<std::uint32_t> threadsCount{};
+    thread_local const auto index = threadsCount.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  // Returns false if the sample was not written yet, or was overwritten
+  bool read(std::uint64_t index, Sample &sample) const noexcept
+  {
+    const auto &slot = slots[index % Capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1) return false;
+    const auto phaseAndThread = slot.phaseAndThread.load(std::memory_order_relaxed);
+    sample.phase = static_cast<Phase>(phaseAndThread & 0xFF);
+    sample.thread = phaseAndThread >> 8;
+    sample.start = std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{
+      slot.start.load(std::memory_order_relaxed) } };
+    sample.duration = std::chrono::steady_clock::duration{ slot.duration.load(std::memory_order_relaxed) };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+  }
+
+  // Calls f(sample) for the available samples, from the newest to the oldest, until f returns false
+  template<typename F> void forEachNewest(F &&f) const
+  {
+    const auto end = head.load(std::memory_order_acquire);
+    const auto begin = end > Capacity ? end - Capacity : 0;
+    Sample sample{};
+    for (auto index = end; index-- > begin;)
+      if (read(index, sample) && !f(sample)) return;
+  }
+
+public:
+  bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+  void enable(bool on) noexcept { enabled.store(on, std::memory_order_relaxed); }
+
+  void record(Phase phase,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::duration duration) noexcept
+  {
+    const auto index = head.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = slots[index % Capacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.phaseAndThread.store(static_cast<std::uint32_t>(phase) | (threadIndex() << 8), std::memory_order_relaxed);
+    slot.start.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+    slot.duration.store(duration.count(), std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+  }
+
+  // Average and 99th percentile of the last samples of each phase, at most window samples per phase
+  template<std::size_t Window = 256> Statistics statistics() const
+  {
+    std::array<std::array<std::chrono::steady_clock::duration, Window>, static_cast<std::size_t>(Phase::Count)>
+      durations{};
+    Statistics result{};
+    std::size_t fullPhases = 0;
+    forEachNewest([&](const Sample &sample) {
+      auto &phase = result[static_cast<std::size_t>(sample.phase)];
+      if (phase.count < Window) {
+        durations[static_cast<std::size_t>(sample.phase)][phase.count++] = sample.duration;
+        if (phase.count == Window) ++fullPhases;
+      }
+      return fullPhases < result.size();
+    });
+
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      auto &phase = result[i];
+      if (phase.count == 0) continue;
+      const auto first = begin(durations[i]);
+      const auto last = first + static_cast<std::ptrdiff_t>(phase.count);
+      std::chrono::steady_clock::duration total{};
+      for (auto it = first; it != last; ++it) total += *it;
+      phase.average = total / static_cast<std::chrono::steady_clock::rep>(phase.count);
+      const auto p99 = first + static_cast<std::ptrdiff_t>((phase.count - 1) * 99 / 100);
+      std::nth_element(first, p99, last);
+      phase.p99 = *p99;
+    }
+    return result;
+  }
+
+  // Writes the samples still in the ring as Chrome trace events, viewable in chrome://tracing or Perfetto
+  void writeTrace(std::ostream &out) const
+  {
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::time_point::max();
+    forEachNewest([&](const Sample &sample) {
+      origin = std::min(origin, sample.start);
+      return true;
+    });
+
+    const auto microseconds = [](std::chrono::steady_clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count();
+    };
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    forEachNewest([&](const Sample &sample) {
+      out << (first ? "\n" : ",\n") << R"({"name":")" << PhaseNames[static_cast<std::size_t>(sample.phase)]
+          << R"(","ph":"X","pid":1,"tid":)" << sample.thread << R"(,"ts":)" << microseconds(sample.start - origin)
+          << R"(,"dur":)" << microseconds(sample.duration) << '}';
+      first = false;
+      return true;
+    });
+    out << "\n]}\n";
+  }
+
+  void writeTrace(const std::string &path) const
+  {
+    std::ofstream file{ path };
+    if (!file) throw std::runtime_error("cannot write the trace '" + path + "'");
+    writeTrace(file);
+  }
+};
+
+inline Profiler profiler{};
+
+// Records the duration of its scope into the profiler, if enabled at its construction
+class PhaseTimer
+{
+  Phase phase;
+  bool enabled;
+  std::chrono::steady_clock::time_point start{};
+
+public:
+  explicit PhaseTimer(Phase p) noexcept : phase{ p }, enabled{ profiler.isEnabled() }
+  {
+    if (enabled) start = std::chrono::steady_clock::now();
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  ~PhaseTimer()
+  {
+    if (enabled) profiler.record(phase, start, std::chrono::steady_clock::now() - start);
+  }
+};
+
+}// namespace atw
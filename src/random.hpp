@@ -0,0 +1,85 @@
+#pragma once
+
+#include "scalar.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace atw {
+
+// xoshiro256** generator: 32 bytes of state, explicitly seeded, and usable with the standard distributions.
+// The seed is expanded into the state with splitmix64, so that close seeds give unrelated sequences.
+class Random
+{
+  static constexpr double Unit = 1.0 / static_cast<double>(std::uint64_t{ 1 } << 53);
+  static constexpr float UnitFloat = 1.0F / static_cast<float>(std::uint64_t{ 1 } << 24);
+
+  std::array<std::uint64_t, 4> state{};
+
+  static constexpr std::uint64_t rotateLeft(std::uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+public:
+  using result_type = std::uint64_t;
+
+  explicit constexpr Random(std::uint64_t seed = 0) noexcept { this->seed(seed); }
+
+  constexpr void seed(std::uint64_t seed) noexcept
+  {
+    for (auto &word : state) {
+      seed += 0x9E3779B97F4A7C15;
+      auto z = seed;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() noexcept { return 0; }
+  static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+  constexpr result_type operator()() noexcept
+  {
+    const auto result = rotateLeft(state[1] * 5, 7) * 9;
+    const auto t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+    return result;
+  }
+
+  // In [min, max), from the 53 upper bits, or the 24 upper bits for floats
+  constexpr double uniform(double min, double max) noexcept
+  {
+    return min + static_cast<double>((*this)() >> 11) * Unit * (max - min);
+  }
+
+  constexpr float uniform(float min, float max) noexcept
+  {
+    return min + static_cast<float>((*this)() >> 40) * UnitFloat * (max - min);
+  }
+
+  // With integers only, from the 32 upper bits
+  constexpr Fixed uniform(Fixed min, Fixed max) noexcept
+  {
+    const auto range = static_cast<std::uint64_t>((max - min).getRaw());
+    return min + Fixed::fromRaw(static_cast<std::int64_t>((((*this)() >> 32) * range) >> 32));
+  }
+
+  // In [min, max], by multiplying the 32 upper bits by the range, whose bias is negligible for small ranges
+  constexpr int uniform(int min, int max) noexcept
+  {
+    const auto range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min + 1);
+    return static_cast<int>(min + static_cast<std::int64_t>((((*this)() >> 32) * range) >> 32));
+  }
+
+  // Fills the values with numbers in [min, max), in one pass
+  template<typename Values, typename T> constexpr void fill(Values &&values, T min, T max) noexcept
+  {
+    for (auto &value : values) value = uniform(min, max);
+  }
+};
+
+}// namespace atw
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "rewind.hpp"
+#include "universe.hpp"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace atw {
+
+// Binary log of the events of a game, from which the game can be replayed exactly.
+// The header holds the magic, the version, the scalar type of the build, whose rounding changes the simulation,
+// and the settings which change the simulation, seed included,
+// and the rewind buffer's memory, which bounds how far the Rewind events go back.
+// Each event is a varint of the nanoseconds elapsed since the previous event, shifted left by 3 bits
+// and combined with the event's type. Mouse events are followed by the zigzag varints of the mouse's moves,
+// whose coordinates are integers, being terminal cells scaled to the canvas' dots.
+// The log ends with an end marker, followed by the 8 bytes of the final state's hash.
+namespace recording {
+  static constexpr std::string_view Magic = "ATWR";
+  static constexpr std::uint64_t Version = 4;
+  static constexpr int TypeBits = 3;
+  static constexpr std::uint64_t EndMarker = (1 << TypeBits) - 1;
+
+  // Code of the scalar type of the build, which only replays the recordings made with the same type
+  template<typename T = Scalar> constexpr std::uint64_t scalarType() noexcept
+  {
+    if constexpr (std::is_same_v<T, double>)
+      return 0;
+    else if constexpr (std::is_same_v<T, float>)
+      return 1;
+    else
+      return 2;
+  }
+
+  inline void writeVarint(std::ostream &out, std::uint64_t value)
+  {
+    while (value >= 0x80) {
+      out.put(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+  }
+
+  inline std::uint64_t readVarint(std::istream &in)
+  {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const auto byte = in.get();
+      if (byte == std::istream::traits_type::eof()) throw std::runtime_error("truncated recording");
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("invalid varint in recording");
+  }
+
+  // The durations are recorded in nanoseconds, whatever the steady clock's period
+  inline std::int64_t nanoseconds(std::chrono::steady_clock::duration d)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+
+  inline std::chrono::steady_clock::duration duration(std::uint64_t count)
+  {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::nanoseconds{ static_cast<std::int64_t>(count) });
+  }
+
+  constexpr std::uint64_t zigzag(std::int64_t value) noexcept
+  {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+  }
+
+  constexpr std::int64_t unzigzag(std::uint64_t value) noexcept
+  {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+  }
+}// namespace recording
+
+class Recorder
+{
+  std::ostream &out;
+  std::chrono::steady_clock::time_point lastTime;
+  std::int64_t lastMouseX{};
+  std::int64_t lastMouseY{};
+
+public:
+  // The start is the time given to the universe's constructor
+  Recorder(std::ostream &output, std::chrono::steady_clock::time_point start, const Settings &settings)
+    : out{ output }, lastTime{ start }
+  {
+    out.write(recording::Magic.data(), static_cast<std::streamsize>(recording::Magic.size()));
+    recording::writeVarint(out, recording::Version);
+    recording::writeVarint(out, recording::scalarType());
+    recording::writeVarint(out, settings.seed);
+    recording::writeVarint(out, settings.initialSatellitesCount);
+    recording::writeVarint(out, settings.indestructibleEarth ? 1 : 0);
+    recording::writeVarint(out, static_cast<std::uint64_t>(settings.collisions));
+    recording::writeVarint(out, static_cast<std::uint64_t>(recording::nanoseconds(settings.tickInterval)));
+    recording::writeVarint(out, settings.maxSatellitesCount);
+    recording::writeVarint(out, static_cast<std::uint64_t>(settings.overflow));
+    recording::writeVarint(out, settings.maxShieldBounces);
+    recording::writeVarint(out, settings.rewindMemory);
+  }
+
+  // Events without effect on the universe are not recorded
+  void record(std::chrono::steady_clock::time_point now, const Event &e)
+  {
+    if (e.type == EventType::Unknown) return;
+    const auto delay = static_cast<std::uint64_t>(recording::nanoseconds(now - lastTime));
+    lastTime = now;
+    recording::writeVarint(out, (delay << recording::TypeBits) | static_cast<std::uint64_t>(e.type));
+    if (e.type != EventType::Mouse) return;
+    const std::int64_t x = std::llround(toDouble(e.mouse.x));
+    const std::int64_t y = std::llround(toDouble(e.mouse.y));
+    recording::writeVarint(out, recording::zigzag(x - lastMouseX));
+    recording::writeVarint(out, recording::zigzag(y - lastMouseY));
+    lastMouseX = x;
+    lastMouseY = y;
+  }
+
+  void finish(std::uint64_t stateHash)
+  {
+    recording::writeVarint(out, recording::EndMarker);
+    std::array<char, sizeof(stateHash)> bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<char>((stateHash >> (8 * i)) & 0xFF);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out.flush();
+  }
+};
+
+struct ReplayResult
+{
+  std::size_t eventsCount{};
+  std::uint64_t stateHash{};
+  // Absent when the recording was interrupted before its end
+  std::optional<std::uint64_t> recordedStateHash{};
+  State state{};
+  std::size_t points{};
+};
+
+// Feeds the recorded events to a new universe, as fast as possible
+inline ReplayResult replay(std::istream &in)
+{
+  std::array<char, recording::Magic.size()> magic{};
+  in.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+  if (!in || std::string_view{ magic.data(), magic.size() } != recording::Magic)
+    throw std::runtime_error("not a recording");
+  if (recording::readVarint(in) != recording::Version) throw std::runtime_error("unsupported recording version");
+  if (recording::readVarint(in) != recording::scalarType())
+    throw std::runtime_error("recording made with another scalar type");
+
+  Settings settings{};
+  settings.seed = recording::readVarint(in);
+  settings.initialSatellitesCount = recording::readVarint(in);
+  settings.indestructibleEarth = recording::readVarint(in) != 0;
+  settings.collisions = static_cast<Collisions>(recording::readVarint(in));
+  settings.tickInterval = recording::duration(recording::readVarint(in));
+  settings.maxSatellitesCount = recording::readVarint(in);
+  settings.overflow = static_cast<Overflow>(recording::readVarint(in));
+  settings.maxShieldBounces = static_cast<std::uint32_t>(recording::readVarint(in));
+  settings.rewindMemory = recording::readVarint(in);
+
+  auto now = std::chrono::steady_clock::time_point{};
+  Universe universe{ now, settings };
+  Rewind rewind{ universe };
+  ReplayResult result{};
+  std::int64_t mouseX = 0;
+  std::int64_t mouseY = 0;
+  while (in.peek() != std::istream::traits_type::eof()) {
+    const auto code = recording::readVarint(in);
+    if (code == recording::EndMarker) {
+      std::array<char, sizeof(std::uint64_t)> bytes{};
+      in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+      if (!in) throw std::runtime_error("truncated recording");
+      std::uint64_t hash = 0;
+      for (std::size_t i = 0; i < bytes.size(); ++i)
+        hash |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+      result.recordedStateHash = hash;
+      break;
+    }
+
+    now += recording::duration(code >> recording::TypeBits);
+    Event e{ static_cast<EventType>(code & recording::EndMarker) };
+    if (e.type == EventType::Mouse) {
+      mouseX += recording::unzigzag(recording::readVarint(in));
+      mouseY += recording::unzigzag(recording::readVarint(in));
+      e.mouse = { toScalar(static_cast<double>(mouseX)), toScalar(static_cast<double>(mouseY)) };
+    }
+    applyEvent(universe, rewind, now, e);
+    ++result.eventsCount;
+  }
+
+  result.stateHash = universe.hash();
+  result.state = universe.getState();
+  result.points = universe.getPoints();
+  return result;
+}
+
+}// namespace atw
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "constellation.hpp"
+#include "grid.hpp"
+#include "universe.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace atw {
+
+// What is recorded of each frame: enough to play it again from a keyframe, and what it changed
+struct RewindFrame
+{
+  std::chrono::steady_clock::duration elapsed{};
+  Scalar shieldAngle{};
+  std::size_t points{};
+  std::uint32_t spawnsCount{};
+  std::uint32_t bouncesCount{};
+  // The bounced satellites' indices kept for the frame, fewer than its bounces when the segment's share is used up
+  std::uint32_t firstBounce{};
+  std::uint32_t keptBouncesCount{};
+};
+
+// Ring of the last frames of a game, to go back a few seconds.
+// The frames are grouped in segments, each starting with a keyframe of the universe at the end of its first frame,
+// followed by compact deltas of its other frames: the universe is restored from the keyframe,
+// then its frames are played again, from their recorded durations and shield's angles, which is exact
+// since the simulation is deterministic. Restoring a frame thus plays at most RewindKeyframeInterval - 1 frames.
+// The memory is allocated upfront, and its budget sets the number of segments: the oldest is reused when all are used.
+class Rewind
+{
+  struct Segment
+  {
+    Universe::Keyframe keyframe{};
+    std::vector<RewindFrame> frames{};
+    std::vector<std::uint32_t> bounces{};
+  };
+
+  std::vector<Segment> segments{};
+  // Index of the oldest segment, and number of segments in use, the last one being the only one not full
+  std::size_t first{};
+  std::size_t count{};
+
+  Segment &segment(std::size_t i) noexcept { return segments[(first + i) % segments.size()]; }
+  const Segment &segment(std::size_t i) const noexcept { return segments[(first + i) % segments.size()]; }
+
+public:
+  static constexpr std::size_t BouncesPerSegment = RewindKeyframeInterval * RewindBouncesPerFrame;
+
+  // Memory used by a segment, with the given satellites' capacity
+  static constexpr std::size_t segmentBytes(std::size_t satellitesCapacity) noexcept
+  {
+    return sizeof(Segment) + Constellation::stateBytes(satellitesCapacity) + Grid::stateBytes(satellitesCapacity)
+           + RewindKeyframeInterval * sizeof(RewindFrame) + BouncesPerSegment * sizeof(std::uint32_t);
+  }
+
+  // With at least two segments, so that there is always a keyframe before the last one
+  explicit Rewind(const Universe &universe)
+  {
+    const auto capacity = universe.getSatellitesCapacity();
+    segments.resize(std::max(std::size_t{ 2 }, universe.getSettings().rewindMemory / segmentBytes(capacity)));
+    for (auto &s : segments) {
+      s.keyframe.satellites.reserveState(capacity);
+      s.keyframe.grid.reserve(capacity);
+      s.frames.reserve(RewindKeyframeInterval);
+      s.bounces.reserve(BouncesPerSegment);
+    }
+  }
+
+  // Records the frame which the universe just played
+  void record(const Universe &universe)
+  {
+    if (count == 0 || segment(count - 1).frames.size() == RewindKeyframeInterval) {
+      if (count == segments.size()) {
+        first = (first + 1) % segments.size();
+        --count;
+      }
+      auto &s = segment(count++);
+      universe.save(s.keyframe);
+      s.frames.clear();
+      s.bounces.clear();
+    }
+
+    auto &s = segment(count - 1);
+    const auto &activity = universe.getFrameActivity();
+    const auto kept = std::min(activity.bounces.size(), BouncesPerSegment - s.bounces.size());
+    s.frames.push_back({ activity.elapsed,
+      activity.shieldAngle,
+      universe.getPoints(),
+      static_cast<std::uint32_t>(activity.spawnsCount),
+      static_cast<std::uint32_t>(activity.bounces.size()),
+      static_cast<std::uint32_t>(s.bounces.size()),
+      static_cast<std::uint32_t>(kept) });
+    const auto bounces = std::span{ activity.bounces }.first(kept);
+    s.bounces.insert(end(s.bounces), begin(bounces), end(bounces));
+  }
+
+  // Number of recorded frames, the oldest first
+  std::size_t size() const noexcept
+  {
+    return count == 0 ? 0 : (count - 1) * RewindKeyframeInterval + segment(count - 1).frames.size();
+  }
+
+  std::size_t getSegmentsCount() const noexcept { return segments.size(); }
+
+  const RewindFrame &frame(std::size_t i) const noexcept
+  {
+    return segment(i / RewindKeyframeInterval).frames[i % RewindKeyframeInterval];
+  }
+
+  std::span<const std::uint32_t> bounces(std::size_t i) const noexcept
+  {
+    const auto &f = frame(i);
+    return std::span{ segment(i / RewindKeyframeInterval).bounces }.subspan(f.firstBounce, f.keptBouncesCount);
+  }
+
+  // Puts the universe back at the end of the given frame, which becomes the last one, its clock going on from now
+  void restore(Universe &universe, std::size_t i, std::chrono::steady_clock::time_point now)
+  {
+    const auto segmentIndex = i / RewindKeyframeInterval;
+    const auto frameIndex = i % RewindKeyframeInterval;
+    auto &s = segment(segmentIndex);
+    universe.restore(s.keyframe);
+    for (std::size_t j = 1; j <= frameIndex; ++j) universe.replayFrame(s.frames[j].elapsed, s.frames[j].shieldAngle);
+    universe.resume(now);
+
+    s.frames.resize(frameIndex + 1);
+    s.bounces.resize(s.frames.back().firstBounce + s.frames.back().keptBouncesCount);
+    count = segmentIndex + 1;
+  }
+
+  // Goes back by RewindDuration, or to the oldest frame, and returns false if there is no frame to go back to
+  bool rewind(Universe &universe, std::chrono::steady_clock::time_point now)
+  {
+    if (size() == 0) return false;
+    auto i = size() - 1;
+    for (std::chrono::steady_clock::duration elapsed{}; i > 0 && elapsed < RewindDuration; --i)
+      elapsed += frame(i).elapsed;
+    restore(universe, i, now);
+    return true;
+  }
+};
+
+// Applies an event to the universe, the rewind buffer recording the frames played and handling the Rewind events
+inline void applyEvent(Universe &universe, Rewind &rewind, std::chrono::steady_clock::time_point now, const Event &e)
+{
+  if (e.type == EventType::Rewind) {
+    rewind.rewind(universe, now);
+    return;
+  }
+  const auto playing = universe.getState() == State::Play;
+  universe.update(now, e);
+  if (playing && e.type == EventType::Frame) rewind.record(universe);
+}
+
+}// namespace atw
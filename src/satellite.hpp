@@ -2,28 +2,58 @@
 #pragma once
 
 #include "configuration.hpp"
+#include "random.hpp"
 #include "shield.hpp"
+#include "stamps.hpp"
 #include "utilities.hpp"
+#include <cstddef>
+#include <span>
 
 namespace atw {
 
-inline Point randomPosition()
+// The satellites appear on the left or the right side of the universe
+inline Scalar randomSide(Random &random) noexcept
 {
-  switch (randomNumber(1, 2)) {
-  case 1:
-    return { .x = 0.0, .y = randomNumber(0.0, static_cast<double>(UniverseHeight)) };
-  case 2:
-  default:
-    return { .x = UniverseWidth, .y = randomNumber(0.0, static_cast<double>(UniverseHeight)) };
-  }
+  return random.uniform(1, 2) == 1 ? Scalar{} : Scalar{ UniverseWidth };
+}
+
+// Half of the range of the angles of the velocities of the satellites appearing at x
+inline Scalar velocityHalfAngle(Scalar x) noexcept
+{
+  return x == Scalar{} ? Pi<> / Scalar{ 4 } : Scalar{ 3 } * Pi<> / Scalar{ 4 };
+}
+
+inline Point randomPosition(Random &random) noexcept
+{
+  const auto x = randomSide(random);
+  return { .x = x, .y = random.uniform(Scalar{}, Scalar{ UniverseHeight }) };
 }
 
-inline Offset randomVelocity(double x) noexcept
+inline Offset randomVelocity(Random &random, Scalar x) noexcept
 {
-  const auto angle = x == 0.0 ? randomNumber(-std::numbers::pi / 4, std::numbers::pi / 4)
-                              : randomNumber(-3 * std::numbers::pi / 4, 3 * std::numbers::pi / 4);
-  const auto speed = randomNumber(SatelliteMinSpeed, SatelliteMaxSpeed);
-  return { speed * std::cos(angle), speed * std::sin(angle) };
+  const auto angle = random.uniform(Scalar{ -1 }, Scalar{ 1 }) * velocityHalfAngle(x);
+  const auto speed = random.uniform(SatelliteMinSpeed, SatelliteMaxSpeed);
+  return { speed * math::cos(angle), speed * math::sin(angle) };
+}
+
+// Batch versions, filling the coordinates of many satellites at once
+inline void randomPositions(Random &random, std::span<Scalar> x, std::span<Scalar> y) noexcept
+{
+  for (auto &value : x) value = randomSide(random);
+  random.fill(y, Scalar{}, Scalar{ UniverseHeight });
+}
+
+inline void randomVelocities(Random &random, std::span<const Scalar> x, std::span<Scalar> dx, std::span<Scalar> dy) noexcept
+{
+  // The angles' fractions and the speeds are first drawn in place, then turned into velocities
+  random.fill(dx, Scalar{ -1 }, Scalar{ 1 });
+  random.fill(dy, SatelliteMinSpeed, SatelliteMaxSpeed);
+  for (std::size_t i = 0; i < dx.size(); ++i) {
+    const auto angle = dx[i] * velocityHalfAngle(x[i]);
+    const auto speed = dy[i];
+    dx[i] = speed * math::cos(angle);
+    dy[i] = speed * math::sin(angle);
+  }
 }
 
 class Satellite
@@ -35,49 +65,75 @@ class Satellite
 public:
   Satellite() = default;
 
-  Satellite(Point p, Offset v) : position{ p }, velocity{ v } {}
+  Satellite(Point p, Offset v, bool r = false) : position{ p }, velocity{ v }, red{ r } {}
 
-  bool isNearEarth() const { return distance(position, EarthCenter) <= EarthRadius + SatelliteRadius; }
+  bool isNearEarth() const { return isNearEarth(position); }
 
-  bool update(const Shield &shield)
+  static constexpr bool isNearEarth(Point p) noexcept
+  {
+    return squaredDistance(p, EarthCenter) <= (EarthRadius + SatelliteRadius) * (EarthRadius + SatelliteRadius);
+  }
+
+  // Whether a satellite moving straight from one point to another touches the Earth on its way
+  static constexpr bool hitsEarth(Point from, Point to) noexcept
+  {
+    return squaredDistance(EarthCenter, Segment{ from, to })
+           <= (EarthRadius + SatelliteRadius) * (EarthRadius + SatelliteRadius);
+  }
+
+  // Where a move which bounced back at the given fraction ends: the rest of the move is made backward
+  static constexpr Point bounceBack(Point start, Offset move, Scalar impact) noexcept
+  {
+    const auto forward = Scalar{ 2 } * impact - Scalar{ 1 };
+    return { start.x + move.dx * forward, start.y + move.dy * forward };
+  }
+
+  // The step is the tick interval, relatively to FrameInterval.
+  // The shield is checked along the whole move, and the satellite bounces back from the point where it touched it.
+  bool update(const Shield &shield, Scalar step = Scalar{ 1 })
   {
     red = !red;
-    position.x += velocity.dx;
-    position.y += velocity.dy;
+    const auto start = position;
+    position.x += velocity.dx * step;
+    position.y += velocity.dy * step;
 
     if (position.x >= UniverseWidth || position.x < 0) {
       velocity.dx = -velocity.dx;
-      position.x += velocity.dx;
+      position.x += velocity.dx * step;
     }
     if (position.y >= UniverseHeight || position.y < 0) {
       velocity.dy = -velocity.dy;
-      position.y += velocity.dy;
+      position.y += velocity.dy * step;
     }
 
-    if (shield.isNear(position)) {
-      velocity.dx = -velocity.dx;
-      velocity.dy = -velocity.dy;
-      position.x += velocity.dx;
-      position.y += velocity.dy;
-      return true;
-    }
-
-    return false;
+    const Offset move{ position.x - start.x, position.y - start.y };
+    const auto impact = shield.timeOfImpact(start, move);
+    if (!impact) return false;
+    velocity.dx = -velocity.dx;
+    velocity.dy = -velocity.dy;
+    position = bounceBack(start, move, *impact);
+    return true;
   }
 
+  Point getPosition() const { return position; }
+  Offset getVelocity() const { return velocity; }
+  bool isRed() const { return red; }
+
   void draw(ftxui::Canvas &canvas) const
   {
-    canvas.DrawBlockCircle(static_cast<int>(position.x),
+    static constexpr auto Circle = circleStamp<SatelliteRadius, false>();
+    drawStamp(canvas,
+      Circle,
+      static_cast<int>(position.x),
       static_cast<int>(position.y),
-      SatelliteRadius,
       red ? ftxui::Color::Red : ftxui::Color::Yellow);
   }
 };
 
-inline Satellite randomSatellite()
+inline Satellite randomSatellite(Random &random)
 {
-  auto pos = randomPosition();
-  return Satellite(pos, randomVelocity(pos.x));
+  auto pos = randomPosition(random);
+  return Satellite(pos, randomVelocity(random, pos.x));
 }
 
 
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <compare>
+#include <concepts>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <type_traits>
+
+namespace atw {
+
+// Fixed point number with 16 fractional bits, computed with integers only,
+// so that a simulation in fixed point is bit-exact whatever the compiler, its flags and the processor.
+// The integer part has 48 bits rather than 16, so that the squared distances across the universe do not overflow.
+class Fixed
+{
+  std::int64_t raw{};
+
+public:
+  static constexpr int FractionBits = 16;
+  static constexpr std::int64_t One = std::int64_t{ 1 } << FractionBits;
+
+  constexpr Fixed() noexcept = default;
+
+  // Implicit, so that the constants and the literals mix with fixed point numbers
+  constexpr Fixed(int value) noexcept : raw{ std::int64_t{ value } * One } {}
+
+  // Rounded to the nearest
+  constexpr Fixed(double value) noexcept
+    : raw{ static_cast<std::int64_t>(value * static_cast<double>(One) + (value < 0.0 ? -0.5 : 0.5)) }
+  {}
+
+  static constexpr Fixed fromRaw(std::int64_t value) noexcept
+  {
+    Fixed result{};
+    result.raw = value;
+    return result;
+  }
+
+  constexpr std::int64_t getRaw() const noexcept { return raw; }
+
+  explicit constexpr operator double() const noexcept { return static_cast<double>(raw) / static_cast<double>(One); }
+
+  // Toward zero, like the conversion of a floating point number
+  explicit constexpr operator int() const noexcept { return static_cast<int>(raw / One); }
+
+  constexpr Fixed operator-() const noexcept { return fromRaw(-raw); }
+
+  constexpr Fixed &operator+=(Fixed other) noexcept
+  {
+    raw += other.raw;
+    return *this;
+  }
+
+  constexpr Fixed &operator-=(Fixed other) noexcept
+  {
+    raw -= other.raw;
+    return *this;
+  }
+
+  // The products and the quotients are rounded down
+  constexpr Fixed &operator*=(Fixed other) noexcept
+  {
+    raw = (raw * other.raw) >> FractionBits;
+    return *this;
+  }
+
+  constexpr Fixed &operator/=(Fixed other) noexcept
+  {
+    raw = (raw << FractionBits) / other.raw;
+    return *this;
+  }
+
+  friend constexpr Fixed operator+(Fixed a, Fixed b) noexcept { return a += b; }
+  friend constexpr Fixed operator-(Fixed a, Fixed b) noexcept { return a -= b; }
+  friend constexpr Fixed operator*(Fixed a, Fixed b) noexcept { return a *= b; }
+  friend constexpr Fixed operator/(Fixed a, Fixed b) noexcept { return a /= b; }
+  friend constexpr bool operator==(const Fixed &, const Fixed &) noexcept = default;
+  friend constexpr std::strong_ordering operator<=>(const Fixed &, const Fixed &) noexcept = default;
+};
+
+#if defined(ATW_SCALAR_FIXED)
+using Scalar = Fixed;
+#elif defined(ATW_SCALAR_FLOAT)
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
+// Conversions which are not casts when the types are the same
+template<typename T = Scalar> constexpr T toScalar(double value) noexcept
+{
+  if constexpr (std::is_same_v<T, double>)
+    return value;
+  else
+    return static_cast<T>(value);
+}
+
+template<typename T> constexpr double toDouble(T value) noexcept
+{
+  if constexpr (std::is_same_v<T, double>)
+    return value;
+  else
+    return static_cast<double>(value);
+}
+
+template<typename T = Scalar> inline constexpr T Pi = toScalar<T>(std::numbers::pi);
+
+// The functions of <cmath> used by the simulation, computed with integers only for fixed point numbers
+namespace math {
+  template<std::floating_point T> T sqrt(T value) noexcept { return std::sqrt(value); }
+  template<std::floating_point T> T abs(T value) noexcept { return std::abs(value); }
+  template<std::floating_point T> T floor(T value) noexcept { return std::floor(value); }
+  template<std::floating_point T> T cos(T angle) noexcept { return std::cos(angle); }
+  template<std::floating_point T> T sin(T angle) noexcept { return std::sin(angle); }
+  template<std::floating_point T> T atan2(T y, T x) noexcept { return std::atan2(y, x); }
+
+  constexpr Fixed abs(Fixed value) noexcept { return value < Fixed{} ? -value : value; }
+
+  constexpr Fixed floor(Fixed value) noexcept { return Fixed::fromRaw(value.getRaw() & ~(Fixed::One - 1)); }
+
+  // Bit by bit square root of the raw value, shifted to keep the fractional bits
+  constexpr Fixed sqrt(Fixed value) noexcept
+  {
+    if (value <= Fixed{}) return {};
+    auto remainder = static_cast<std::uint64_t>(value.getRaw()) << Fixed::FractionBits;
+    std::uint64_t root = 0;
+    std::uint64_t bit = std::uint64_t{ 1 } << 62;
+    while (bit > remainder) bit >>= 2;
+    while (bit != 0) {
+      if (remainder >= root + bit) {
+        remainder -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return Fixed::fromRaw(static_cast<std::int64_t>(root));
+  }
+
+  // Taylor series up to the 9th power, once the angle is brought into [-pi/2, pi/2]
+  constexpr Fixed sin(Fixed angle) noexcept
+  {
+    constexpr auto TwoPi = Fixed::fromRaw(2 * Pi<Fixed>.getRaw());
+    constexpr auto HalfPi = Fixed::fromRaw(Pi<Fixed>.getRaw() / 2);
+    auto x = Fixed::fromRaw(angle.getRaw() % TwoPi.getRaw());
+    if (x > Pi<Fixed>) x -= TwoPi;
+    if (x < -Pi<Fixed>) x += TwoPi;
+    if (x > HalfPi) x = Pi<Fixed> - x;
+    if (x < -HalfPi) x = -Pi<Fixed> - x;
+    const auto x2 = x * x;
+    auto term = x;
+    auto result = x;
+    for (int n = 2; n <= 8; n += 2) {
+      term = -term * x2 / Fixed{ n * (n + 1) };
+      result += term;
+    }
+    return result;
+  }
+
+  constexpr Fixed cos(Fixed angle) noexcept { return sin(angle + Fixed::fromRaw(Pi<Fixed>.getRaw() / 2)); }
+
+  // Taylor series, once the argument in [0, 1] is brought under tan(pi/12),
+  // with atan(z) = pi/6 + atan((z.sqrt(3) - 1) / (sqrt(3) + z))
+  constexpr Fixed atanUnit(Fixed z) noexcept
+  {
+    constexpr Fixed TanPiOver12{ 2.0 - std::numbers::sqrt3 };
+    constexpr Fixed Sqrt3{ std::numbers::sqrt3 };
+    Fixed offset{};
+    if (z > TanPiOver12) {
+      offset = Pi<Fixed> / Fixed{ 6 };
+      z = (z * Sqrt3 - Fixed{ 1 }) / (Sqrt3 + z);
+    }
+    const auto z2 = z * z;
+    auto power = z;
+    auto result = z;
+    for (int n = 3; n <= 7; n += 2) {
+      power = -power * z2;
+      result += power / Fixed{ n };
+    }
+    return offset + result;
+  }
+
+  constexpr Fixed atan2(Fixed y, Fixed x) noexcept
+  {
+    const auto absX = abs(x);
+    const auto absY = abs(y);
+    if (absX == Fixed{} && absY == Fixed{}) return {};
+    auto angle = absY <= absX ? atanUnit(absY / absX) : Fixed::fromRaw(Pi<Fixed>.getRaw() / 2) - atanUnit(absX / absY);
+    if (x < Fixed{}) angle = Pi<Fixed> - angle;
+    return y < Fixed{} ? -angle : angle;
+  }
+}// namespace math
+
+}// namespace atw
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace atw {
+
+// Histogram of the delays between the frames' deadlines and the actual wake ups,
+// with power of two buckets of microseconds: [0, 1us), [1us, 2us), [2us, 4us), ... [2^(N-2)us, +inf)
+class JitterHistogram
+{
+public:
+  static constexpr std::size_t BucketsCount = 20;
+  using Counts = std::array<std::uint64_t, BucketsCount>;
+
+private:
+  std::array<std::atomic<std::uint64_t>, BucketsCount> buckets{};
+
+public:
+  static std::size_t bucketOf(std::chrono::steady_clock::duration delay) noexcept
+  {
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+    std::size_t bucket = 0;
+    for (auto limit = 1LL; bucket < BucketsCount - 1 && micros >= limit; limit *= 2) ++bucket;
+    return bucket;
+  }
+
+  // Lower bound of the bucket
+  static std::chrono::microseconds bucketStart(std::size_t bucket) noexcept
+  {
+    return std::chrono::microseconds{ bucket == 0 ? 0 : 1LL << (bucket - 1) };
+  }
+
+  void record(std::chrono::steady_clock::duration delay) noexcept
+  {
+    buckets[bucketOf(delay)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Counts counts() const noexcept
+  {
+    Counts result{};
+    for (std::size_t i = 0; i < BucketsCount; ++i) result[i] = buckets[i].load(std::memory_order_relaxed);
+    return result;
+  }
+};
+
+// Calls onFrame at a fixed rate, on its own thread, but only as often as needed:
+// onFrame returns when it needs to be called again, the deadlines until then being skipped, and wake() asks for the
+// next deadline, for instance when an input arrives. Until then, the thread sleeps.
+// The deadlines are absolute, so that the period does not drift with the time spent in onFrame.
+// When deadlines are missed, they are counted and skipped, keeping the frames aligned on the initial phase.
+// The destruction wakes the thread immediately.
+class Scheduler
+{
+public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+  // When onFrame does not need to be called again, until woken
+  static constexpr TimePoint Never = TimePoint::max();
+
+private:
+  std::chrono::steady_clock::duration interval;
+  std::function<TimePoint()> onFrame;
+  std::mutex mutex{};
+  std::condition_variable wakeUp{};
+  bool stopping{};
+  bool woken{};
+  std::atomic<std::uint64_t> framesCount{};
+  std::atomic<std::uint64_t> missedDeadlinesCount{};
+  JitterHistogram jitter{};
+  TimePoint origin{ std::chrono::steady_clock::now() };
+  std::thread thread{};
+
+  // First deadline at or after the given time
+  TimePoint deadlineFrom(TimePoint time) const noexcept
+  {
+    if (time == Never) return Never;
+    if (time <= origin) return origin;
+    return origin + (time - origin + interval - std::chrono::steady_clock::duration{ 1 }) / interval * interval;
+  }
+
+  void run()
+  {
+    auto deadline = origin + interval;
+    std::unique_lock lock{ mutex };
+    const auto awake = [this] { return stopping || woken; };
+    while (!stopping) {
+      if (woken) {
+        woken = false;
+        deadline = std::min(deadline, deadlineFrom(std::chrono::steady_clock::now()));
+      }
+      if (deadline == Never) {
+        wakeUp.wait(lock, awake);
+        continue;
+      }
+      if (wakeUp.wait_until(lock, deadline, awake)) continue;
+
+      lock.unlock();
+      jitter.record(std::chrono::steady_clock::now() - deadline);
+      const auto next = onFrame();
+      framesCount.fetch_add(1, std::memory_order_relaxed);
+
+      // The deadlines skipped on request are not missed: only those from the requested one on are counted
+      deadline = std::max(deadline + interval, deadlineFrom(next));
+      const auto now = std::chrono::steady_clock::now();
+      if (deadline != Never && now >= deadline) {
+        const auto missed = (now - deadline) / interval + 1;
+        missedDeadlinesCount.fetch_add(static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+        deadline += missed * interval;
+      }
+      lock.lock();
+    }
+  }
+
+public:
+  Scheduler(std::chrono::steady_clock::duration frameInterval, std::function<TimePoint()> frameCallback)
+    : interval{ frameInterval }, onFrame{ std::move(frameCallback) }, thread{ [this] { run(); } }
+  {}
+
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  ~Scheduler()
+  {
+    {
+      const std::lock_guard lock{ mutex };
+      stopping = true;
+    }
+    wakeUp.notify_one();
+    thread.join();
+  }
+
+  // Calls onFrame at the next deadline, even if it asked for a later one
+  void wake()
+  {
+    {
+      const std::lock_guard lock{ mutex };
+      woken = true;
+    }
+    wakeUp.notify_one();
+  }
+
+  std::uint64_t getFramesCount() const noexcept { return framesCount.load(std::memory_order_relaxed); }
+  std::uint64_t getMissedDeadlinesCount() const noexcept
+  {
+    return missedDeadlinesCount.load(std::memory_order_relaxed);
+  }
+  JitterHistogram::Counts getJitter() const noexcept { return jitter.counts(); }
+};
+
+}// namespace atw
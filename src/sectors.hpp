@@ -0,0 +1,119 @@
+#pragma once
+
+#include "configuration.hpp"
+#include "utilities.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace atw {
+
+// Polar index of the satellites around the Earth.
+// The satellites are bucketed by radial band: the Earth's band, where they may hit the Earth,
+// and the shield's band, where they are further bucketed by angular sector.
+// Both bands are conservative: a satellite outside them can neither be near the Earth nor near the shield.
+// They are widened by a margin, the longest move of the satellites, so that they also hold the satellites
+// which may have touched the Earth or the shield on their way, and the bands then overlap when the margin is large.
+class Sectors
+{
+public:
+  static constexpr int Count = 64;
+  static constexpr Scalar EarthBandRadius = EarthRadius + SatelliteRadius;
+  static constexpr Scalar ShieldBandInnerRadius = ShieldRadius - SatelliteRadius;
+  // The round ends of the capsule around the shield are the farthest from the Earth:
+  // (sqrt(ShieldRadius² + ShieldSpan²) + SatelliteRadius)², bounded without the square root
+  static constexpr Scalar SquaredShieldBandOuterRadius =
+    (ShieldRadius + SatelliteRadius) * (ShieldRadius + SatelliteRadius) + ShieldSpan * ShieldSpan
+    + 2 * SatelliteRadius * ShieldSpan;
+  // Memory of the sectors' starts, allocated upfront whatever the number of satellites
+  static constexpr std::size_t FixedBytes = (2 * Count + 1) * sizeof(std::size_t);
+
+private:
+  static constexpr Scalar SectorAngle = Scalar{ 2 } * Pi<> / Scalar{ Count };
+
+  std::vector<Scalar> squaredRadii{};
+  std::vector<std::size_t> earthBand{};
+  std::vector<std::size_t> shieldBand{};
+  std::vector<int> shieldBandSectors{};
+  std::vector<std::size_t> sectorStarts = std::vector<std::size_t>(Count + 1);
+  std::vector<std::size_t> sectorSlots = std::vector<std::size_t>(Count);
+  std::vector<std::size_t> sectorSatellites{};
+  Scalar halfShieldAngle{};
+
+  static int sectorOf(Scalar polarAngle) noexcept
+  {
+    const auto sector = static_cast<int>(math::floor(polarAngle / SectorAngle)) % Count;
+    return sector < 0 ? sector + Count : sector;
+  }
+
+public:
+  // So that updating up to capacity satellites does not allocate
+  void reserve(std::size_t capacity)
+  {
+    squaredRadii.reserve(capacity);
+    earthBand.reserve(capacity);
+    shieldBand.reserve(capacity);
+    shieldBandSectors.reserve(capacity);
+    sectorSatellites.reserve(capacity);
+  }
+
+  void update(std::span<const Scalar> x, std::span<const Scalar> y, Scalar margin = {})
+  {
+    const auto earthBandRadius = EarthBandRadius + margin;
+    const auto squaredEarthBandRadius = earthBandRadius * earthBandRadius;
+    const auto innerRadius = std::max(ShieldBandInnerRadius - margin, Scalar{});
+    const auto squaredInnerRadius = innerRadius * innerRadius;
+    const auto outerRadius = math::sqrt(SquaredShieldBandOuterRadius) + margin;
+    const auto squaredOuterRadius = outerRadius * outerRadius;
+    // Around the Earth's center, the satellites may touch the shield whatever their polar angle
+    halfShieldAngle =
+      innerRadius > Scalar{} ? math::atan2(Scalar{ ShieldSpan + SatelliteRadius } + margin, innerRadius) : Pi<>;
+
+    // Computed first in a separate loop, which the compiler can vectorize
+    squaredRadii.resize(x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) squaredRadii[i] = squaredDistance({ x[i], y[i] }, EarthCenter);
+
+    earthBand.clear();
+    shieldBand.clear();
+    shieldBandSectors.clear();
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      const auto squaredRadius = squaredRadii[i];
+      if (squaredRadius <= squaredEarthBandRadius) earthBand.push_back(i);
+      if (squaredRadius >= squaredInnerRadius && squaredRadius <= squaredOuterRadius) {
+        shieldBand.push_back(i);
+        shieldBandSectors.push_back(sectorOf(math::atan2(y[i] - EarthCenter.y, x[i] - EarthCenter.x)));
+      }
+    }
+
+    // Counting sort of the shield's band by sector
+    std::fill(begin(sectorStarts), end(sectorStarts), 0);
+    for (const auto sector : shieldBandSectors) ++sectorStarts[static_cast<std::size_t>(sector) + 1];
+    for (std::size_t sector = 0; sector < Count; ++sector) sectorStarts[sector + 1] += sectorStarts[sector];
+    sectorSatellites.resize(shieldBand.size());
+    std::copy_n(begin(sectorStarts), Count, begin(sectorSlots));
+    for (std::size_t k = 0; k < shieldBand.size(); ++k)
+      sectorSatellites[sectorSlots[static_cast<std::size_t>(shieldBandSectors[k])]++] = shieldBand[k];
+  }
+
+  // For a satellite which moved after the update, and is now in the Earth's band
+  void addToEarthBand(std::size_t i) { earthBand.push_back(i); }
+
+  const std::vector<std::size_t> &getEarthBand() const { return earthBand; }
+
+  // Calls f(i) for the satellites in the sectors spanned by a shield whose middle is at the given polar angle,
+  // widened by the margin
+  template<typename F> void forEachNearShield(Scalar shieldPolarAngle, F &&f) const
+  {
+    const bool all = halfShieldAngle >= Pi<>;
+    const auto first = all ? 0 : sectorOf(shieldPolarAngle - halfShieldAngle);
+    const auto last = all ? Count - 1 : sectorOf(shieldPolarAngle + halfShieldAngle);
+    for (auto sector = first;; sector = (sector + 1) % Count) {
+      const auto s = static_cast<std::size_t>(sector);
+      for (auto k = sectorStarts[s]; k < sectorStarts[s + 1]; ++k) f(sectorSatellites[k]);
+      if (sector == last) break;
+    }
+  }
+};
+
+}// namespace atw
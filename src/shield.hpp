@@ -2,26 +2,29 @@
 #pragma once
 
 #include "configuration.hpp"
+#include "painter.hpp"
+#include "stamps.hpp"
 #include "utilities.hpp"
 #include <ftxui/component/captured_mouse.hpp>// for ftxui
 #include <ftxui/component/component.hpp>// for Slider
 #include <ftxui/component/screen_interactive.hpp>// for ScreenInteractive
-#include <numbers>
+#include <algorithm>
+#include <optional>
 
 namespace atw {
 
 class Shield
 {
-  double angle{};
+  Scalar angle{};
   Segment segment{ transpose(ShieldLeft, CenterOffset), transpose(ShieldRight, CenterOffset) };
 
 public:
   void update(const Point &mouse)
   {
-    update(std::atan2(mouse.y - CenterOffset.dy, mouse.x - CenterOffset.dx) + std::numbers::pi / 2);
+    update(math::atan2(mouse.y - CenterOffset.dy, mouse.x - CenterOffset.dx) + Pi<> / Scalar{ 2 });
   }
 
-  void update(double a)
+  void update(Scalar a)
   {
     angle = a;
     segment = Segment{
@@ -34,35 +37,43 @@ public:
 
   void rotateRight() { update(angle + ShieldAngleStep); }
 
-  void draw(ftxui::Canvas &canvas) const
-  {
-    canvas.DrawBlockLine(static_cast<int>(segment.p1.x),
-      static_cast<int>(segment.p1.y),
-      static_cast<int>(segment.p2.x),
-      static_cast<int>(segment.p2.y),
-      ftxui::Color::DarkOrange);
-    canvas.DrawBlockCircleFilled(
-      static_cast<int>(segment.p1.x), static_cast<int>(segment.p1.y), 2, ftxui::Color::DarkOrange);
-    canvas.DrawBlockCircleFilled(
-      static_cast<int>(segment.p2.x), static_cast<int>(segment.p2.y), 2, ftxui::Color::DarkOrange);
-  }
+  // Polar angle of the middle of the shield, around the Earth
+  Scalar polarAngle() const noexcept { return angle - Pi<> / Scalar{ 2 }; }
 
-  bool isNear(const Point &point) const
+  void draw(Painter &painter) const
   {
-    const auto distanceToShield = distance(point, segment);
-    if (distanceToShield > SatelliteRadius) return false;
+    static constexpr int EndRadius = 2;
+    static constexpr auto End = circleStamp<EndRadius, true>();
+    const auto x1 = static_cast<int>(segment.p1.x);
+    const auto y1 = static_cast<int>(segment.p1.y);
+    const auto x2 = static_cast<int>(segment.p2.x);
+    const auto y2 = static_cast<int>(segment.p2.y);
+    painter.touch({ std::min(x1, x2) - EndRadius - 1,
+      std::min(y1, y2) - EndRadius - 1,
+      std::max(x1, x2) + EndRadius + 1,
+      std::max(y1, y2) + EndRadius + 1 });
 
-    const auto distanceToP1 = distance(point, segment.p1);
-    if (distanceToP1 > ShieldSpan * 2) return false;
+    auto &canvas = painter.getCanvas();
+    canvas.DrawBlockLine(x1, y1, x2, y2, ftxui::Color::DarkOrange);
+    drawStamp(canvas, End, x1, y1, ftxui::Color::DarkOrange);
+    drawStamp(canvas, End, x2, y2, ftxui::Color::DarkOrange);
+  }
 
-    const auto distanceToP2 = distance(point, segment.p2);
-    if (distanceToP2 > ShieldSpan * 2) return false;
+  // A satellite is near the shield when it touches the capsule around its segment
+  bool isNear(const Point &point) const noexcept
+  {
+    return squaredDistance(point, segment) <= SatelliteRadius * SatelliteRadius;
+  }
 
-    return true;
+  // Fraction of a satellite's move at which it reaches the shield, if it does, so that it cannot go through it
+  std::optional<Scalar> timeOfImpact(const Point &start, const Offset &move) const noexcept
+  {
+    return atw::timeOfImpact(start, move, segment, Scalar{ SatelliteRadius });
   }
 
+  Scalar getAngle() const noexcept { return angle; }
+
   // For unit tests only
-  double getAngle() const { return angle; }
   const Segment &getSegment() const { return segment; }
 };
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ftxui/dom/canvas.hpp>
+#include <array>
+#include <cstddef>
+
+namespace atw {
+
+// Offset of a dot from the center of a shape
+struct Dot
+{
+  int dx{};
+  int dy{};
+};
+
+// Dots of a shape, rasterized at compile time, and drawn by offsetting them
+template<std::size_t N> using Stamp = std::array<Dot, N>;
+
+// The dots of a disk are those in the circle, the dots of a ring those whose distance to the center rounds to the radius
+constexpr bool isInCircle(int dx, int dy, int radius, bool filled) noexcept
+{
+  const auto squaredDistance = dx * dx + dy * dy;
+  if (squaredDistance > radius * radius + radius) return false;
+  return filled ? squaredDistance <= radius * radius : squaredDistance > radius * radius - radius;
+}
+
+constexpr std::size_t circleDotsCount(int radius, bool filled) noexcept
+{
+  std::size_t count = 0;
+  for (int dy = -radius; dy <= radius; ++dy)
+    for (int dx = -radius; dx <= radius; ++dx)
+      if (isInCircle(dx, dy, radius, filled)) ++count;
+  return count;
+}
+
+template<int Radius, bool Filled> constexpr auto circleStamp() noexcept
+{
+  Stamp<circleDotsCount(Radius, Filled)> stamp{};
+  std::size_t i = 0;
+  for (int dy = -Radius; dy <= Radius; ++dy)
+    for (int dx = -Radius; dx <= Radius; ++dx)
+      if (isInCircle(dx, dy, Radius, Filled)) stamp[i++] = { dx, dy };
+  return stamp;
+}
+
+template<std::size_t N>
+void drawStamp(ftxui::Canvas &canvas, const Stamp<N> &stamp, int x, int y, const ftxui::Color &color)
+{
+  for (const auto &dot : stamp) canvas.DrawBlock(x + dot.dx, y + dot.dy, true, color);
+}
+
+}// namespace atw
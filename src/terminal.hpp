@@ -0,0 +1,259 @@
+#pragma once
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace atw {
+
+// Writes the frames to the terminal, from its top left corner, with only the characters of the cells which changed
+// since the previous frame. The cursor moves and the style changes are only written when the next changed cell needs
+// them, so that runs of changed cells with the same style are written as plain text.
+class TerminalWriter
+{
+public:
+  static constexpr std::string_view EnterAlternateScreen = "\x1B[?1049h";
+  static constexpr std::string_view LeaveAlternateScreen = "\x1B[?1049l";
+  static constexpr std::string_view HideCursor = "\x1B[?25l";
+  static constexpr std::string_view ShowCursor = "\x1B[?25h";
+  // Reports all the mouse's moves, with the SGR encoding
+  static constexpr std::string_view EnableMouse = "\x1B[?1003h\x1B[?1006h";
+  static constexpr std::string_view DisableMouse = "\x1B[?1006l\x1B[?1003l";
+
+private:
+  int width{};
+  int height{};
+  // Cells as displayed by the terminal
+  std::vector<ftxui::Pixel> displayed{};
+  int invalidFramesCount{ 1 };
+  ftxui::Pixel style{};
+  int cursorX{ -1 };
+  int cursorY{ -1 };
+  std::string output{};
+  std::size_t lastFrameBytes{};
+
+  static bool sameStyle(const ftxui::Pixel &a, const ftxui::Pixel &b) noexcept
+  {
+    return a.bold == b.bold && a.dim == b.dim && a.underlined == b.underlined && a.blink == b.blink
+           && a.inverted == b.inverted && a.foreground_color == b.foreground_color
+           && a.background_color == b.background_color;
+  }
+
+  void moveCursor(int x, int y)
+  {
+    if (x == cursorX && y == cursorY) return;
+    auto move = "\x1B[" + std::to_string(y + 1) + ';' + std::to_string(x + 1) + 'H';
+    if (y == cursorY && x > cursorX) {
+      auto forward = "\x1B[" + std::to_string(x - cursorX) + 'C';
+      if (forward.size() < move.size()) move = std::move(forward);
+    }
+    output += move;
+    cursorX = x;
+    cursorY = y;
+  }
+
+  void setStyle(const ftxui::Pixel &pixel)
+  {
+    if (pixel.bold != style.bold || pixel.dim != style.dim) {
+      output += "\x1B[22m";
+      if (pixel.bold) output += "\x1B[1m";
+      if (pixel.dim) output += "\x1B[2m";
+    }
+    if (pixel.underlined != style.underlined) output += pixel.underlined ? "\x1B[4m" : "\x1B[24m";
+    if (pixel.blink != style.blink) output += pixel.blink ? "\x1B[5m" : "\x1B[25m";
+    if (pixel.inverted != style.inverted) output += pixel.inverted ? "\x1B[7m" : "\x1B[27m";
+    if (!(pixel.foreground_color == style.foreground_color))
+      output += "\x1B[" + pixel.foreground_color.Print(false) + 'm';
+    if (!(pixel.background_color == style.background_color))
+      output += "\x1B[" + pixel.background_color.Print(true) + 'm';
+    style = pixel;
+  }
+
+  // Clears the terminal, whose cells are then all blank with the default style
+  void reset(int newWidth, int newHeight)
+  {
+    width = newWidth;
+    height = newHeight;
+    displayed.assign(static_cast<std::size_t>(width * height), ftxui::Pixel{});
+    style = ftxui::Pixel{};
+    cursorX = -1;
+    cursorY = -1;
+    output += "\x1B[0m\x1B[2J";
+  }
+
+public:
+  // Writes entirely the given number of next frames, for when the terminal was modified by someone else
+  void invalidate(int framesCount = 1) noexcept { invalidFramesCount = framesCount; }
+
+  // Returns what updates the terminal from the previous frame to this one
+  const std::string &update(ftxui::Screen &screen)
+  {
+    output.clear();
+    if (invalidFramesCount > 0 || screen.dimx() != width || screen.dimy() != height) {
+      if (invalidFramesCount > 0) --invalidFramesCount;
+      reset(screen.dimx(), screen.dimy());
+    }
+
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const auto &pixel = screen.PixelAt(x, y);
+        auto &cell = displayed[static_cast<std::size_t>(y * width + x)];
+        if (pixel.character == cell.character && sameStyle(pixel, cell)) continue;
+        cell = pixel;
+        // The second half of a wide character is written with its first half
+        if (pixel.character.empty()) continue;
+        moveCursor(x, y);
+        setStyle(pixel);
+        output += pixel.character;
+        ++cursorX;
+        // After a wide character, the cursor's column is not known anymore
+        if (x + 1 < width && screen.PixelAt(x + 1, y).character.empty()) cursorY = -1;
+      }
+    }
+
+    lastFrameBytes = output.size();
+    return output;
+  }
+
+  std::size_t getLastFrameBytes() const noexcept { return lastFrameBytes; }
+};
+
+// Translates the bytes read from a terminal in raw mode to its inputs: the characters, the keys used by the game,
+// and the mouse's SGR reports, whose coordinates are cells from the top left corner.
+// The other escape sequences are skipped. A sequence split between two reads is completed by the next one,
+// so that an escape byte is only the escape key when it ends the bytes read, or is not followed by a sequence.
+class TerminalReader
+{
+public:
+  enum class Key : std::uint8_t {
+    Character,
+    Escape,
+    Left,
+    Right,
+    Return,
+    Backspace,
+    Mouse,
+  };
+
+  struct Input
+  {
+    Key key{};
+    char character{};
+    int x{};
+    int y{};
+  };
+
+private:
+  static constexpr char Escape = '\x1B';
+
+  std::string pending{};
+
+  static bool parseInt(std::string_view text, int &value) noexcept
+  {
+    const auto *last = text.data() + text.size();
+    const auto [end, error] = std::from_chars(text.data(), last, value);
+    return error == std::errc{} && end == last;
+  }
+
+  // The mouse's report "<button;x;y", whose coordinates start at 1
+  static bool parseMouse(std::string_view parameters, Input &input) noexcept
+  {
+    if (!parameters.starts_with('<')) return false;
+    const auto first = parameters.find(';');
+    if (first == std::string_view::npos) return false;
+    const auto second = parameters.find(';', first + 1);
+    if (second == std::string_view::npos) return false;
+    int x = 0;
+    int y = 0;
+    if (!parseInt(parameters.substr(first + 1, second - first - 1), x) || !parseInt(parameters.substr(second + 1), y))
+      return false;
+    input = { Key::Mouse, {}, x - 1, y - 1 };
+    return true;
+  }
+
+  // Calls f(input) for the input at the start of the bytes, and returns the number of bytes used,
+  // 0 when the bytes end before the input
+  template<typename F> static std::size_t parseOne(std::string_view bytes, F &f)
+  {
+    const auto c = bytes[0];
+    if (c != Escape) {
+      switch (c) {
+      case '\r':
+      case '\n':
+        f(Input{ Key::Return });
+        break;
+      case '\x7F':
+      case '\b':
+        f(Input{ Key::Backspace });
+        break;
+      // Ctrl+C, the terminal's signals being disabled
+      case '\x03':
+        f(Input{ Key::Escape });
+        break;
+      default:
+        f(Input{ Key::Character, c });
+        break;
+      }
+      return 1;
+    }
+
+    if (bytes.size() < 2) return 0;
+    if (bytes[1] == 'O') {
+      if (bytes.size() < 3) return 0;
+      if (bytes[2] == 'D') f(Input{ Key::Left });
+      if (bytes[2] == 'C') f(Input{ Key::Right });
+      return 3;
+    }
+    if (bytes[1] != '[') {
+      f(Input{ Key::Escape });
+      return 1;
+    }
+
+    // Control sequence: parameters, ended by a byte from '@' to '~'
+    std::size_t end = 2;
+    while (end < bytes.size() && (bytes[end] < '@' || bytes[end] > '~')) ++end;
+    if (end == bytes.size()) return 0;
+    const auto parameters = bytes.substr(2, end - 2);
+    Input input{};
+    switch (bytes[end]) {
+    case 'D':
+      f(Input{ Key::Left });
+      break;
+    case 'C':
+      f(Input{ Key::Right });
+      break;
+    case 'M':
+    case 'm':
+      if (parseMouse(parameters, input)) f(input);
+      break;
+    default:
+      break;
+    }
+    return end + 1;
+  }
+
+public:
+  // Calls f(input) for the inputs completed by the bytes read
+  template<typename F> void parse(std::string_view bytes, F &&f)
+  {
+    pending += bytes;
+    std::size_t parsed = 0;
+    while (parsed < pending.size()) {
+      const auto used = parseOne(std::string_view{ pending }.substr(parsed), f);
+      if (used == 0) break;
+      parsed += used;
+    }
+    pending.erase(0, parsed);
+    if (pending.size() == 1 && pending[0] == Escape) {
+      pending.clear();
+      f(Input{ Key::Escape });
+    }
+  }
+};
+
+}// namespace atw
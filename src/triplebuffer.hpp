@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace atw {
+
+// Hands the latest complete value from one writer thread to one reader thread, without locks nor waits.
+// The writer fills the back buffer and publishes it by swapping it with the middle one, marked fresh;
+// the reader takes the middle buffer only when it is fresh, by swapping it with its front buffer.
+// Neither of them ever touches the buffer held by the other, so the buffers can keep their allocations.
+template<typename T> class TripleBuffer
+{
+  static constexpr std::uint8_t IndexMask = 3;
+  static constexpr std::uint8_t Fresh = 4;
+
+  std::array<T, 3> buffers{};
+  std::atomic<std::uint8_t> middle{ 1 };
+  // Only used by the writer
+  std::uint8_t back{ 0 };
+  // Only used by the reader
+  std::uint8_t front{ 2 };
+
+public:
+  T &getBack() noexcept { return buffers[back]; }
+
+  void publish() noexcept { back = middle.exchange(back | Fresh, std::memory_order_acq_rel) & IndexMask; }
+
+  // Whether a value was published since the last one read
+  bool isFresh() const noexcept { return (middle.load(std::memory_order_relaxed) & Fresh) != 0; }
+
+  // The last published value, or the previous one read if none was published since
+  const T &getLatest() noexcept
+  {
+    if ((middle.load(std::memory_order_relaxed) & Fresh) != 0)
+      front = middle.exchange(front, std::memory_order_acq_rel) & IndexMask;
+    return buffers[front];
+  }
+};
+
+}// namespace atw
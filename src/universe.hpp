@@ -2,12 +2,23 @@
 #pragma once
 
 #include "configuration.hpp"
+#include "constellation.hpp"
 #include "earth.hpp"
+#include "grid.hpp"
+#include "random.hpp"
+#include "painter.hpp"
+#include "profiler.hpp"
 #include "satellite.hpp"
 #include "shield.hpp"
 #include "utilities.hpp"
+#include "workers.hpp"
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace atw {
 
@@ -24,6 +35,8 @@ enum class EventType {
   Mouse,
   Left,
   Right,
+  // Goes back a few seconds, handled by the rewind buffer rather than by the universe
+  Rewind,
 };
 
 struct Event
@@ -32,41 +45,178 @@ struct Event
   Point mouse{};
 };
 
+inline const std::vector<std::string> IntroText{
+  "ONCE UPON A TIME, IN A NEAR NEAR GALAXY,",
+  "CHANCELLOR PALPUTIN HAS TAKEN CONTROL",
+  "OVER ALL SATELLITES OF THE STARLUKE COMPANY.",
+  "THEY THREATEN TO CRASH ON EARTH AND DESTROY IT.",
+  "ELONMUSH, A SMART JEDI, IMAGINES A DESPERATE DEFENSE:",
+  "TO MANEUVER THE INTERNATIONAL SPACE STATION",
+  "AND USE IT AS A SHIELD TO PROTECT THE EARTH.",
+  "ALAS, HE IS NOT BOLD ENOUGH TO DO IT BY HIMSELF.",
+  ". . .",
+  "BUT, YOU, O YOUNG PADAWAN, WILL YOU TAKE UP THE CHALLENGE",
+  "AND DRIVE THE ISS AND TRY RESISTING AS LONG AS YOU CAN?!",
+  ". . .",
+  "TYPE [RETURN] TO START THE GAME, THEN MOVE THE MOUSE OR TYPE [RIGHT]/[LEFT] TO MOVE THE ISS AROUND THE EARTH",
+};
+
+// What the renderer needs of the universe at the end of a frame.
+// It is a copy, so that it can be drawn on another thread while the simulation goes on.
+struct Snapshot
+{
+  State state{ State::Intro };
+  std::size_t points{};
+  Earth earth{};
+  Shield shield{};
+  Constellation satellites{};
+  // Fraction of a tick elapsed since the last tick
+  Scalar interpolation{};
+  int introTextOffset{};
+
+  // The painter keeps the canvas from frame to frame: during the game, only the cells touched by the moving shapes
+  // are repainted, with the background under them.
+  // The given elements are appended to the side panel.
+  ftxui::Element draw(Painter &painter, ftxui::Elements panel = {}) const
+  {
+    if (state == State::Intro) {
+      painter.clear();
+      drawIntro(painter);
+    } else {
+      drawGame(painter);
+    }
+
+    panel.insert(begin(panel),
+      { panelLine(painter, "Satellites: ", satellites.size()), panelLine(painter, "Points: ", points) });
+    return ftxui::hbox(
+      { ftxui::canvas(&painter.getCanvas()) | ftxui::borderDouble, ftxui::separator(), ftxui::vbox(std::move(panel)) });
+  }
+
+  // Line of the side panel, built in the painter's reused text without temporary strings.
+  // The element keeps its own copy, which is allocated when longer than the short string buffer.
+  static ftxui::Element panelLine(Painter &painter, std::string_view label, std::size_t value)
+  {
+    auto &line = painter.getText();
+    line.assign(label);
+    std::array<char, 20> digits{};
+    const auto digitsEnd = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+    line.append(digits.data(), digitsEnd);
+    return ftxui::text(line);
+  }
+
+  // Hash of what is drawn, so that a frame which would be drawn the same is not drawn again
+  std::uint64_t hash() const noexcept
+  {
+    auto result = hashCombine(std::uint64_t{}, static_cast<std::uint64_t>(state));
+    result = hashCombine(result, std::uint64_t{ points });
+    result = hashCombine(result, static_cast<std::uint64_t>(introTextOffset));
+    result = hashCombine(result, shield.polarAngle());
+    result = hashCombine(result, interpolation);
+    return satellites.drawingHash(result);
+  }
+
+  void drawGame(Painter &painter) const
+  {
+    if (painter.beginScene(static_cast<int>(state)))
+      earth.draw(painter.getCanvas(), CanvasBox);
+    else
+      painter.restore([&](const Box &box) { earth.draw(painter.getCanvas(), box); });
+    shield.draw(painter);
+    satellites.draw(painter, interpolation);
+  }
+
+  void drawIntro(Painter &painter) const
+  {
+    int lineIndex = 0;
+    for (const auto &line : IntroText) {
+      ++lineIndex;
+      drawIntroLine(painter, lineIndex, line);
+    }
+  }
+
+  void drawIntroLine(Painter &painter, int lineIndex, const std::string &line) const
+  {
+    const auto lineY = introTextOffset + lineIndex * CharHeight * 2;
+    const auto offsetY = (UniverseHeight - lineY) * 2;
+    const auto desiredWidth = UniverseWidth - offsetY;
+    const auto desiredLength = desiredWidth / CharWidth;
+    auto &stretchedLine = painter.getText();
+    stretchText(static_cast<std::size_t>(desiredLength), line, stretchedLine);
+    const auto lineSize = stretchedLine.length() * CharWidth;
+    const auto remainingSize = UniverseWidth > lineSize ? UniverseWidth - lineSize : 0;
+    const auto lineX = static_cast<int>(remainingSize / 2);
+    painter.getCanvas().DrawText(lineX, lineY, stretchedLine, ftxui::Color::BlueLight);
+  }
+};
+
+// What changed during the last frame, besides the shield's angle
+struct FrameActivity
+{
+  std::chrono::steady_clock::duration elapsed{};
+  Scalar shieldAngle{};
+  std::size_t spawnsCount{};
+  // Indices of the satellites which bounced on the shield, at the time of the bounces
+  std::vector<std::uint32_t> bounces{};
+};
+
 class Universe
 {
+  Settings settings{};
+  std::size_t satellitesCapacity{};
+  Random random{};
+  Scalar tickStep{};
   std::size_t points{};
   std::chrono::steady_clock::time_point lastSatelliteCreationTime{};
+  std::chrono::steady_clock::time_point simulationTime{};
+  std::chrono::steady_clock::time_point lastFrameTime{};
+  std::chrono::steady_clock::duration lag{};
   Earth earth{};
   Shield shield{};
-  std::vector<Satellite> satellites{};
+  Constellation satellites{};
+  Grid grid{};
+  // When empty, the satellites are random
   std::function<Satellite()> createSatellite{};
   State state{ State::Intro };
-  std::vector<std::string> introText{
-    "ONCE UPON A TIME, IN A NEAR NEAR GALAXY,",
-    "CHANCELLOR PALPUTIN HAS TAKEN CONTROL",
-    "OVER ALL SATELLITES OF THE STARLUKE COMPANY.",
-    "THEY THREATEN TO CRASH ON EARTH AND DESTROY IT.",
-    "ELONMUSH, A SMART JEDI, IMAGINES A DESPERATE DEFENSE:",
-    "TO MANEUVER THE INTERNATIONAL SPACE STATION",
-    "AND USE IT AS A SHIELD TO PROTECT THE EARTH.",
-    "ALAS, HE IS NOT BOLD ENOUGH TO DO IT BY HIMSELF.",
-    ". . .",
-    "BUT, YOU, O YOUNG PADAWAN, WILL YOU TAKE UP THE CHALLENGE",
-    "AND DRIVE THE ISS AND TRY RESISTING AS LONG AS YOU CAN?!",
-    ". . .",
-    "TYPE [RETURN] TO START THE GAME, THEN MOVE THE MOUSE OR TYPE [RIGHT]/[LEFT] TO MOVE THE ISS AROUND THE EARTH",
-  };
   int introTextOffset{ UniverseHeight - CharHeight * 2 };
   std::chrono::steady_clock::time_point lastIntroTextScrollTime{};
+  FrameActivity activity{};
 
 public:
-  explicit Universe(std::chrono::steady_clock::time_point now, std::function<Satellite()> satelliteCreator)
-    : lastSatelliteCreationTime{ now }, createSatellite{ std::move(satelliteCreator) }, lastIntroTextScrollTime{ now }
+  // The state of a game, from which it goes on exactly as it did, but for the satellites' creator's own state.
+  // The grid is part of it, since the order of its lists is the order of the collisions.
+  struct Keyframe
+  {
+    Random random{};
+    std::size_t points{};
+    std::chrono::steady_clock::time_point lastSatelliteCreationTime{};
+    std::chrono::steady_clock::time_point simulationTime{};
+    std::chrono::steady_clock::time_point lastFrameTime{};
+    std::chrono::steady_clock::duration lag{};
+    Earth earth{};
+    Shield shield{};
+    Constellation satellites{};
+    Grid grid{};
+    State state{ State::Intro };
+  };
+
+  explicit Universe(std::chrono::steady_clock::time_point now,
+    std::function<Satellite()> satelliteCreator,
+    Settings s = {})
+    : settings{ s }, satellitesCapacity{ std::max(settings.initialSatellitesCount, settings.maxSatellitesCount) },
+      random{ settings.seed },
+      tickStep{ toScalar(std::chrono::duration<double>(settings.tickInterval) / FrameInterval) },
+      lastSatelliteCreationTime{ now }, createSatellite{ std::move(satelliteCreator) },
+      lastIntroTextScrollTime{ now }
   {
-    satellites.resize(InitialSatellitesCount);
-    std::generate(begin(satellites), end(satellites), createSatellite);
+    satellites.reserve(satellitesCapacity);
+    grid.reserve(satellitesCapacity);
+    activity.bounces.reserve(static_cast<std::size_t>(MaxCatchUpTicks) * satellitesCapacity);
+    createSatellites(settings.initialSatellitesCount);
   }
 
+  // With random satellites, drawn from the settings' seed
+  explicit Universe(std::chrono::steady_clock::time_point now, Settings s = {}) : Universe{ now, {}, s } {}
+
   void update(std::chrono::steady_clock::time_point now, const Event &e)
   {
     switch (state) {
@@ -87,6 +237,8 @@ public:
     switch (e.type) {
     case EventType::Start:
       state = State::Play;
+      simulationTime = now;
+      lastFrameTime = now;
       break;
     case EventType::Frame:
       if (now - lastIntroTextScrollTime >= IntroTextScrollInterval) {
@@ -112,70 +264,166 @@ public:
       shield.rotateRight();
       break;
     case EventType::Frame:
-      for (auto &satellite : satellites)
-        if (satellite.update(shield)) points += satellites.size();
-      if (!earth.update(satellites)) {
-        state = State::End;
-      } else if (now - lastSatelliteCreationTime >= SatelliteCreationInterval) {
-        lastSatelliteCreationTime = now;
-        satellites.push_back(createSatellite());
-      }
+      updateTicks(now);
       break;
     default:
       break;
     }
   }
 
-  auto draw() const
+  // Steps the simulation at the fixed tick interval, catching up with the frames' time when late.
+  // When too late, the remaining ticks are dropped, so that the game slows down instead of spiraling.
+  void updateTicks(std::chrono::steady_clock::time_point now)
   {
-    auto universeComponent = ftxui::Renderer([&] {
-      auto canvas = ftxui::Canvas(UniverseWidth, UniverseHeight);
-      if (state == State::Intro)
-        drawIntro(canvas);
-      else
-        drawGame(canvas);
-      return ftxui::canvas(std::move(canvas));
-    });
+    activity.elapsed = now - lastFrameTime;
+    activity.shieldAngle = shield.getAngle();
+    activity.spawnsCount = 0;
+    activity.bounces.clear();
+    lag += now - lastFrameTime;
+    lastFrameTime = now;
+    for (int ticks = 0; lag >= settings.tickInterval && state == State::Play && ticks < MaxCatchUpTicks; ++ticks) {
+      updateTick();
+      lag -= settings.tickInterval;
+    }
+    if (lag >= settings.tickInterval) lag %= settings.tickInterval;
+  }
 
-    return ftxui::hbox({ universeComponent->Render() | ftxui::borderDouble,
-      ftxui::separator(),
-      ftxui::vbox({ ftxui::text("Satellites: " + std::to_string(satellites.size())),
-        ftxui::text("Points: " + std::to_string(points)) }) });
+  bool updateEarth()
+  {
+    const PhaseTimer timer{ Phase::Earth };
+    return earth.update(satellites);
   }
 
-  void drawGame(ftxui::Canvas &canvas) const
+  void updateTick()
   {
-    earth.draw(canvas);
-    shield.draw(canvas);
-    for (const auto &satellite : satellites) satellite.draw(canvas);
+    simulationTime += settings.tickInterval;
+    const auto hits = satellites.size() >= settings.parallelSatellitesCount
+                        ? satellites.update(shield, tickStep, workerPool())
+                        : satellites.update(shield, tickStep);
+    points += hits * satellites.size();
+    if (hits > 0) satellites.appendBounced(activity.bounces);
+    satellites.collide(grid, settings.collisions);
+    if (settings.maxShieldBounces > 0) satellites.despawn(settings.maxShieldBounces);
+    if (!settings.indestructibleEarth && !updateEarth()) {
+      state = State::End;
+    } else if (simulationTime - lastSatelliteCreationTime >= SatelliteCreationInterval) {
+      lastSatelliteCreationTime = simulationTime;
+      createSatellites(1);
+    }
   }
 
-  void drawIntro(ftxui::Canvas &canvas) const
+  // When full, the new satellites are rejected, or replace the oldest ones
+  void createSatellites(std::size_t count)
   {
-    int lineIndex = 0;
-    for (const auto &line : introText) {
-      ++lineIndex;
-      drawIntroLine(canvas, lineIndex, line);
+    count = std::min(count, satellitesCapacity);
+    if (settings.overflow == Overflow::RecycleOldest)
+      while (satellites.size() + count > satellitesCapacity) satellites.erase(satellites.oldest());
+    count = std::min(count, satellitesCapacity - satellites.size());
+    activity.spawnsCount += count;
+
+    if (!createSatellite) {
+      satellites.spawn(random, count);
+      return;
     }
+    for (std::size_t i = 0; i < count; ++i) satellites.push_back(createSatellite());
   }
 
-  void drawIntroLine(ftxui::Canvas &canvas, int lineIndex, const std::string &line) const
+  // Saves the state into a keyframe whose arrays keep their capacity from save to save
+  void save(Keyframe &keyframe) const
   {
-    const auto lineY = introTextOffset + lineIndex * CharHeight * 2;
-    const auto offsetY = (UniverseHeight - lineY) * 2;
-    const auto desiredWidth = UniverseWidth - offsetY;
-    const auto desiredLength = desiredWidth / CharWidth;
-    const auto stretchedLine = stretchText(static_cast<std::size_t>(desiredLength), line);
-    const auto lineSize = stretchedLine.length() * CharWidth;
-    const auto remainingSize = UniverseWidth > lineSize ? UniverseWidth - lineSize : 0;
-    const auto lineX = static_cast<int>(remainingSize / 2);
-    canvas.DrawText(lineX, lineY, stretchedLine, ftxui::Color::BlueLight);
+    keyframe.random = random;
+    keyframe.points = points;
+    keyframe.lastSatelliteCreationTime = lastSatelliteCreationTime;
+    keyframe.simulationTime = simulationTime;
+    keyframe.lastFrameTime = lastFrameTime;
+    keyframe.lag = lag;
+    keyframe.earth = earth;
+    keyframe.shield = shield;
+    satellites.copyStateTo(keyframe.satellites);
+    keyframe.grid = grid;
+    keyframe.state = state;
+  }
+
+  void restore(const Keyframe &keyframe)
+  {
+    random = keyframe.random;
+    points = keyframe.points;
+    lastSatelliteCreationTime = keyframe.lastSatelliteCreationTime;
+    simulationTime = keyframe.simulationTime;
+    lastFrameTime = keyframe.lastFrameTime;
+    lag = keyframe.lag;
+    earth = keyframe.earth;
+    shield = keyframe.shield;
+    keyframe.satellites.copyStateTo(satellites);
+    grid = keyframe.grid;
+    state = keyframe.state;
+  }
+
+  // Plays again a frame of a game restored from a keyframe, from its recorded duration and shield's angle
+  void replayFrame(std::chrono::steady_clock::duration elapsed, Scalar shieldAngle)
+  {
+    shield.update(shieldAngle);
+    updateTicks(lastFrameTime + elapsed);
+  }
+
+  // Moves the game's clock to now, without elapsed time, so that a restored game goes on from there
+  void resume(std::chrono::steady_clock::time_point now)
+  {
+    const auto shift = now - lastFrameTime;
+    lastSatelliteCreationTime += shift;
+    simulationTime += shift;
+    lastFrameTime = now;
+  }
+
+  // Copies what the drawing needs, into a snapshot whose arrays are reused from frame to frame
+  void snapshot(Snapshot &s) const
+  {
+    s.state = state;
+    s.points = points;
+    s.earth = earth;
+    s.shield = shield;
+    satellites.copyTo(s.satellites);
+    s.interpolation = getInterpolation();
+    s.introTextOffset = introTextOffset;
+  }
+
+  // Hash of the state of the simulation, to check that two runs are the same
+  std::uint64_t hash() const noexcept
+  {
+    auto result = hashCombine(std::uint64_t{}, static_cast<std::uint64_t>(state));
+    result = hashCombine(result, std::uint64_t{ points });
+    result = hashCombine(result, static_cast<std::uint64_t>(lag.count()));
+    result = hashCombine(result, shield.polarAngle());
+    return satellites.hash(result);
   }
 
+  // When the drawing changes next without events: at the next frame during the game, at the next scroll of the
+  // intro, and never once the intro has scrolled or the game is over
+  std::chrono::steady_clock::time_point getNextVisibleChange() const noexcept
+  {
+    switch (state) {
+    case State::Intro:
+      return introTextOffset > 0 ? lastIntroTextScrollTime + IntroTextScrollInterval
+                                 : std::chrono::steady_clock::time_point::max();
+    case State::Play:
+      return lastFrameTime;
+    case State::End:
+    default:
+      return std::chrono::steady_clock::time_point::max();
+    }
+  }
+
+  // Fraction of a tick elapsed since the last tick
+  Scalar getInterpolation() const { return toScalar(std::chrono::duration<double>(lag) / settings.tickInterval); }
+
+  const FrameActivity &getFrameActivity() const noexcept { return activity; }
+  const Settings &getSettings() const noexcept { return settings; }
+  std::size_t getSatellitesCapacity() const noexcept { return satellitesCapacity; }
+
   // For unit tests only
   std::size_t getPoints() const { return points; }
   const Shield &getShield() const { return shield; }
-  const std::vector<Satellite> &getSatellites() const { return satellites; }
+  const Constellation &getSatellites() const { return satellites; }
   State getState() const { return state; }
   int getIntroTextOffset() const { return introTextOffset; }
 };
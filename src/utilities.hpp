@@ -1,81 +1,175 @@
 
 #pragma once
 
+#include "scalar.hpp"
 #include <algorithm>
-#include <cmath>
-#include <random>
+#include <bit>
+#include <cstdint>
+#include <optional>
 #include <string>
 
 namespace atw {
 
-struct Point
+// The geometry is templated on the scalar type, and the simulation uses the one chosen at build time
+template<typename T> struct BasicPoint
 {
-  double x{};
-  double y{};
+  T x{};
+  T y{};
 };
 
-struct Segment
+template<typename T> struct BasicSegment
 {
-  Point p1{};
-  Point p2{};
+  BasicPoint<T> p1{};
+  BasicPoint<T> p2{};
 };
 
-struct Offset
+template<typename T> struct BasicOffset
 {
-  double dx{};
-  double dy{};
+  T dx{};
+  T dy{};
 };
 
-constexpr inline Point transpose(Point p, Offset offset) noexcept { return { p.x + offset.dx, p.y + offset.dy }; }
+using Point = BasicPoint<Scalar>;
+using Segment = BasicSegment<Scalar>;
+using Offset = BasicOffset<Scalar>;
 
-inline Point rotate(Point p, double angle) noexcept
+template<typename T> constexpr BasicPoint<T> transpose(BasicPoint<T> p, BasicOffset<T> offset) noexcept
 {
-  const auto co = std::cos(angle);
-  const auto si = std::sin(angle);
+  return { p.x + offset.dx, p.y + offset.dy };
+}
+
+template<typename T> constexpr BasicPoint<T> rotate(BasicPoint<T> p, T angle) noexcept
+{
+  const auto co = math::cos(angle);
+  const auto si = math::sin(angle);
   return { p.x * co - p.y * si, p.x * si + p.y * co };
 }
 
-inline auto distance(Point p1, Point p2) noexcept
+template<typename T> constexpr T squaredDistance(BasicPoint<T> p1, BasicPoint<T> p2) noexcept
 {
   const auto diffX = p2.x - p1.x;
   const auto diffY = p2.y - p1.y;
-  const auto dist = std::sqrt(diffX * diffX + diffY * diffY);
-  return dist;
+  return diffX * diffX + diffY * diffY;
+}
+
+template<typename T> constexpr T distance(BasicPoint<T> p1, BasicPoint<T> p2) noexcept
+{
+  return math::sqrt(squaredDistance(p1, p2));
+}
+
+// Squared distance to the nearest point of the segment, ends included
+template<typename T> constexpr T squaredDistance(BasicPoint<T> p, BasicSegment<T> s) noexcept
+{
+  const auto ex = s.p2.x - s.p1.x;
+  const auto ey = s.p2.y - s.p1.y;
+  const auto squaredLength = ex * ex + ey * ey;
+  const auto projection = (p.x - s.p1.x) * ex + (p.y - s.p1.y) * ey;
+  const auto t = squaredLength > T{} ? std::clamp(projection / squaredLength, T{}, T{ 1 }) : T{};
+  return squaredDistance(p, BasicPoint<T>{ s.p1.x + ex * t, s.p1.y + ey * t });
 }
 
-inline auto distance(Point p, Segment s) noexcept
+// Distance to the line through the segment
+template<typename T> constexpr T distance(BasicPoint<T> p, BasicSegment<T> s) noexcept
 {
   if (s.p2.x != s.p1.x) {
     const auto m = (s.p2.y - s.p1.y) / (s.p2.x - s.p1.x);
-    const auto num = std::abs(-m * p.x + 1 * p.y - s.p1.y + m * s.p1.x);
-    const auto den = std::sqrt(-m * -m + 1 * 1);
+    const auto num = math::abs(-m * p.x + p.y - s.p1.y + m * s.p1.x);
+    const auto den = math::sqrt(m * m + T{ 1 });
     return num / den;
   }
-  return std::abs(p.x - s.p1.x);
+  return math::abs(p.x - s.p1.x);
 }
 
-inline auto &randomGenerator()
+// Swept tests of a point moving from start to start + move, against a circle and against a capsule
+// (the points within a radius of a segment). They return the fraction of the move at which the point reaches the shape,
+// if it does: 0 when the point starts inside, unless it moves away, so that a point can always leave a shape.
+template<typename T>
+constexpr std::optional<T>
+  timeOfImpact(BasicPoint<T> start, BasicOffset<T> move, BasicPoint<T> center, T radius) noexcept
 {
-  static std::random_device rd{};
-  static std::mt19937 gen{ rd() };
-  return gen;
+  const auto fx = start.x - center.x;
+  const auto fy = start.y - center.y;
+  const auto approach = fx * move.dx + fy * move.dy;
+  if (fx * fx + fy * fy <= radius * radius) return approach > T{} ? std::nullopt : std::optional<T>{ T{} };
+  if (approach >= T{}) return std::nullopt;
+
+  // Smallest root of |start + t.move - center|² = radius²
+  const auto squaredMove = move.dx * move.dx + move.dy * move.dy;
+  // In fixed point, the square of a very short move rounds to 0, and the move cannot reach the circle anyway
+  if (squaredMove <= T{}) return std::nullopt;
+  const auto discriminant = approach * approach - squaredMove * (fx * fx + fy * fy - radius * radius);
+  if (discriminant < T{}) return std::nullopt;
+  const auto t = (-approach - math::sqrt(discriminant)) / squaredMove;
+  return t <= T{ 1 } ? std::optional<T>{ t } : std::nullopt;
 }
 
-inline int randomNumber(int min, int max)
+template<typename T>
+constexpr std::optional<T>
+  timeOfImpact(BasicPoint<T> start, BasicOffset<T> move, BasicSegment<T> capsule, T radius) noexcept
 {
-  std::uniform_int_distribution<> distrib(min, max);
-  return distrib(randomGenerator());
+  const auto ex = capsule.p2.x - capsule.p1.x;
+  const auto ey = capsule.p2.y - capsule.p1.y;
+  const auto squaredLength = ex * ex + ey * ey;
+
+  // Signed distance to the capsule's line, times the segment's length, and its change over the move
+  const auto side = ex * (start.y - capsule.p1.y) - ey * (start.x - capsule.p1.x);
+  const auto sideChange = ex * move.dy - ey * move.dx;
+
+  // Most moves stay on one side of the line, out of reach
+  const auto sideEnd = side + sideChange;
+  const auto squaredReach = radius * radius * squaredLength;
+  if (side * sideEnd > T{} && side * side > squaredReach && sideEnd * sideEnd > squaredReach) return std::nullopt;
+
+  if (squaredDistance(start, capsule) <= radius * radius) {
+    const auto projection = (start.x - capsule.p1.x) * ex + (start.y - capsule.p1.y) * ey;
+    if (projection <= T{} || projection >= squaredLength) {
+      const auto end = projection <= T{} ? capsule.p1 : capsule.p2;
+      return timeOfImpact(start, move, end, radius);
+    }
+    return side * sideChange > T{} ? std::nullopt : std::optional<T>{ T{} };
+  }
+
+  // The flat sides, reached when the distance to the line gets down to the radius, between the ends
+  std::optional<T> result{};
+  if (side * sideChange < T{}) {
+    const auto t = (math::abs(side) - radius * math::sqrt(squaredLength)) / math::abs(sideChange);
+    const auto projection = (start.x + move.dx * t - capsule.p1.x) * ex + (start.y + move.dy * t - capsule.p1.y) * ey;
+    if (t >= T{} && t <= T{ 1 } && projection >= T{} && projection <= squaredLength) result = t;
+  }
+
+  // The round ends
+  for (const auto &end : { capsule.p1, capsule.p2 }) {
+    const auto t = timeOfImpact(start, move, end, radius);
+    if (t && (!result || *t < *result)) result = t;
+  }
+  return result;
 }
 
-inline double randomNumber(double min, double max)
+// Mixes a value into a hash, to hash a whole state
+constexpr inline std::uint64_t hashCombine(std::uint64_t hash, std::uint64_t value) noexcept
 {
-  std::uniform_real_distribution<> distrib(min, max);
-  return distrib(randomGenerator());
+  return hash ^ (value + 0x9E3779B97F4A7C15 + (hash << 6) + (hash >> 2));
 }
 
-inline std::string stretchText(std::size_t desiredLength, const std::string &text)
+constexpr inline std::uint64_t hashCombine(std::uint64_t hash, double value) noexcept
 {
-  std::string stretchedText{};
+  return hashCombine(hash, std::bit_cast<std::uint64_t>(value));
+}
+
+constexpr inline std::uint64_t hashCombine(std::uint64_t hash, float value) noexcept
+{
+  return hashCombine(hash, std::uint64_t{ std::bit_cast<std::uint32_t>(value) });
+}
+
+constexpr inline std::uint64_t hashCombine(std::uint64_t hash, Fixed value) noexcept
+{
+  return hashCombine(hash, static_cast<std::uint64_t>(value.getRaw()));
+}
+
+// Into a given string, so that its capacity can be reused
+inline void stretchText(std::size_t desiredLength, const std::string &text, std::string &stretchedText)
+{
+  stretchedText.clear();
   if (text.length() < desiredLength) {
     const auto desiredGrowth = desiredLength - text.length();
     const auto existingSpacesCount = static_cast<unsigned>(std::count(begin(text), end(text), ' '));
@@ -86,9 +180,16 @@ inline std::string stretchText(std::size_t desiredLength, const std::string &tex
         for (std::size_t i = 0; i < insertedSpacesCountPerExistingSpace; ++i) stretchedText += c;
       }
     }
-    return stretchedText;
+    return;
   }
-  return text;
+  stretchedText = text;
+}
+
+inline std::string stretchText(std::size_t desiredLength, const std::string &text)
+{
+  std::string stretchedText{};
+  stretchText(desiredLength, text, stretchedText);
+  return stretchedText;
 }
 
 }// namespace atw
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace atw {
+
+// Fixed pool of threads running the chunks of a task, with the calling thread.
+// Each run is a generation: the workers wake up, take the chunks one at a time until none is left,
+// and the run returns once no worker is busy anymore, so that the task can live on the caller's stack.
+// A new run waits for the workers of the previous one, before replacing the task.
+class WorkerPool
+{
+  std::mutex mutex{};
+  std::condition_variable wakeUp{};
+  std::condition_variable idle{};
+  std::uint64_t generation{};
+  std::size_t busyCount{};
+  bool stopping{};
+  void (*task)(void *, std::size_t){};
+  void *context{};
+  std::size_t chunksCount{};
+  std::atomic<std::size_t> nextChunk{};
+  std::vector<std::thread> threads{};
+
+  void runChunks(void (*chunkTask)(void *, std::size_t), void *chunkContext, std::size_t count)
+  {
+    for (auto chunk = nextChunk.fetch_add(1); chunk < count; chunk = nextChunk.fetch_add(1))
+      chunkTask(chunkContext, chunk);
+  }
+
+  void work()
+  {
+    std::uint64_t seenGeneration = 0;
+    std::unique_lock lock{ mutex };
+    for (;;) {
+      wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+      if (stopping) return;
+      seenGeneration = generation;
+      ++busyCount;
+      const auto chunkTask = task;
+      auto *const chunkContext = context;
+      const auto count = chunksCount;
+      lock.unlock();
+      runChunks(chunkTask, chunkContext, count);
+      lock.lock();
+      if (--busyCount == 0) idle.notify_all();
+    }
+  }
+
+public:
+  // The calling thread works too, so that a pool of n threads runs n + 1 chunks at the same time
+  explicit WorkerPool(std::size_t threadsCount)
+  {
+    threads.reserve(threadsCount);
+    for (std::size_t i = 0; i < threadsCount; ++i) threads.emplace_back([this] { work(); });
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool()
+  {
+    {
+      const std::lock_guard lock{ mutex };
+      stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &thread : threads) thread.join();
+  }
+
+  std::size_t getThreadsCount() const noexcept { return threads.size(); }
+
+  // Calls f(chunk) for each chunk in [0, count), and returns once they are all done
+  template<typename F> void run(std::size_t count, F &&f)
+  {
+    const auto call = [](void *c, std::size_t chunk) { (*static_cast<std::remove_reference_t<F> *>(c))(chunk); };
+    {
+      std::unique_lock lock{ mutex };
+      idle.wait(lock, [&] { return busyCount == 0; });
+      task = call;
+      context = &f;
+      chunksCount = count;
+      nextChunk.store(0);
+      ++generation;
+    }
+    wakeUp.notify_all();
+    runChunks(call, &f, count);
+    std::unique_lock lock{ mutex };
+    idle.wait(lock, [&] { return busyCount == 0; });
+  }
+};
+
+// Shared by all the universes, created on first use with a thread per additional core
+inline WorkerPool &workerPool()
+{
+  static WorkerPool pool{ std::max(std::thread::hardware_concurrency(), 1U) - 1 };
+  return pool;
+}
+
+}// namespace atw
@@ -0,0 +1,99 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The global operators new and delete are replaced in the tests, so that they can check that some code does not
+// allocate. All their forms are replaced, so that each allocation is counted, and freed by the same allocator
+// which allocated it: the sanitizers' runtimes would otherwise report the mismatches.
+
+static std::atomic<std::size_t> allocations{};
+static std::atomic<std::size_t> bytes{};
+
+std::size_t allocationsCount() noexcept { return allocations.load(std::memory_order_relaxed); }
+
+std::size_t allocatedBytes() noexcept { return bytes.load(std::memory_order_relaxed); }
+
+static void *allocate(std::size_t size) noexcept
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+static void *allocate(std::size_t size, std::align_val_t alignment) noexcept
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  const auto align = static_cast<std::size_t>(alignment);
+  // The size of an aligned allocation is a multiple of its alignment
+  const auto alignedSize = (size == 0 ? 1 : size + align - 1) / align * align;
+#ifdef _MSC_VER
+  return _aligned_malloc(alignedSize, align);
+#else
+  return std::aligned_alloc(align, alignedSize);
+#endif
+}
+
+static void deallocate(void *pointer) noexcept { std::free(pointer); }
+
+static void deallocate(void *pointer, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+static void *allocateOrThrow(std::size_t size)
+{
+  if (auto *pointer = allocate(size)) return pointer;
+  throw std::bad_alloc{};
+}
+
+static void *allocateOrThrow(std::size_t size, std::align_val_t alignment)
+{
+  if (auto *pointer = allocate(size, alignment)) return pointer;
+  throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size) { return allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return allocateOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocateOrThrow(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocateOrThrow(size, alignment); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return allocate(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return allocate(size, alignment);
+}
+
+void operator delete(void *pointer) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void *pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete(void *pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+  deallocate(pointer, alignment);
+}
+void operator delete[](void *pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+  deallocate(pointer, alignment);
+}
+void operator delete(void *pointer, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  deallocate(pointer, alignment);
+}
+void operator delete[](void *pointer, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  deallocate(pointer, alignment);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+// Number of calls to the global operator new since the start of the tests
+std::size_t allocationsCount() noexcept;
+
+// Number of bytes asked to the global operator new since the start of the tests, freed or not
+std::size_t allocatedBytes() noexcept;
@@ -0,0 +1,248 @@
+#define CATCH_CONFIG_MAIN// This tells the catch header to generate a main
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "../src/autopilot.hpp"
+#include "../src/constellation.hpp"
+#include "../src/earth.hpp"
+#include "../src/grid.hpp"
+#include "../src/painter.hpp"
+#include "../src/rewind.hpp"
+#include "../src/satellite.hpp"
+#include "../src/shield.hpp"
+#include "../src/universe.hpp"
+#include "../src/utilities.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Run with "-r json" to write the benchmarks' results as JSON, which compare_benchmarks.py compares between builds
+class JsonReporter : public Catch::StreamingReporterBase<JsonReporter>
+{
+  struct Result
+  {
+    std::string name{};
+    double mean{};
+    double standardDeviation{};
+    std::size_t samples{};
+  };
+
+  std::vector<Result> results{};
+
+public:
+  using StreamingReporterBase::StreamingReporterBase;
+
+  static std::string getDescription() { return "Reports the benchmarks' means and standard deviations as JSON"; }
+
+  void assertionStarting(const Catch::AssertionInfo &) override {}
+  bool assertionEnded(const Catch::AssertionStats &) override { return true; }
+
+  void benchmarkEnded(const Catch::BenchmarkStats<> &stats) override
+  {
+    results.push_back(
+      { stats.info.name, stats.mean.point.count(), stats.standardDeviation.point.count(), stats.samples.size() });
+  }
+
+  void testRunEnded(const Catch::TestRunStats &stats) override
+  {
+    stream << "{\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      const auto &result = results[i];
+      stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << result.name << "\", \"mean_ns\": " << result.mean
+             << ", \"standard_deviation_ns\": " << result.standardDeviation << ", \"samples\": " << result.samples
+             << " }";
+    }
+    stream << "\n  ]\n}\n";
+    StreamingReporterBase::testRunEnded(stats);
+  }
+};
+
+CATCH_REGISTER_REPORTER("json", JsonReporter)
+
+namespace {
+
+// Satellites spread over the whole universe, as they are after a while of play
+atw::Constellation uniformConstellation(std::size_t count)
+{
+  atw::Random random{ 1 };
+  atw::Constellation constellation{};
+  constellation.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const atw::Point position{ random.uniform(atw::Scalar{}, atw::Scalar{ atw::UniverseWidth }),
+      random.uniform(atw::Scalar{}, atw::Scalar{ atw::UniverseHeight }) };
+    constellation.push_back(atw::Satellite{ position, atw::randomVelocity(random, position.x) });
+  }
+  return constellation;
+}
+
+// Reference O(n²) broad phase
+std::size_t countCollisionsPairwise(const atw::Constellation &constellation)
+{
+  static constexpr atw::Scalar SquaredCollisionDistance{ (2 * atw::SatelliteRadius) * (2 * atw::SatelliteRadius) };
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < constellation.size(); ++i)
+    for (std::size_t j = i + 1; j < constellation.size(); ++j)
+      if (atw::squaredDistance(constellation[i].getPosition(), constellation[j].getPosition())
+          <= SquaredCollisionDistance)
+        ++count;
+  return count;
+}
+
+}// namespace
+
+TEST_CASE("collisions scale with the number of satellites", "[!benchmark][collisions]")
+{
+  for (const std::size_t count : { 1000U, 2000U, 4000U, 8000U, 16000U }) {
+    auto constellation = uniformConstellation(count);
+    atw::Grid grid{};
+    const atw::Shield shield{};
+
+    BENCHMARK("grid bounce " + std::to_string(count))
+    {
+      constellation.update(shield);
+      constellation.collide(grid, atw::Collisions::Bounce);
+      return constellation.size();
+    };
+  }
+
+  for (const std::size_t count : { 1000U, 2000U, 4000U }) {
+    const auto constellation = uniformConstellation(count);
+
+    BENCHMARK("pairwise " + std::to_string(count)) { return countCollisionsPairwise(constellation); };
+  }
+}
+
+TEST_CASE("geometry", "[!benchmark][geometry]")
+{
+  atw::Random random{ 1 };
+  const atw::Point p1{ random.uniform(atw::Scalar{}, atw::Scalar{ 300 }),
+    random.uniform(atw::Scalar{}, atw::Scalar{ 150 }) };
+  const atw::Point p2{ random.uniform(atw::Scalar{}, atw::Scalar{ 300 }),
+    random.uniform(atw::Scalar{}, atw::Scalar{ 150 }) };
+  const atw::Segment segment{ { 140, 35 }, { 160, 36 } };
+  const auto angle = random.uniform(atw::Scalar{}, atw::Scalar{ 6 });
+
+  BENCHMARK("distance point/point") { return atw::distance(p1, p2); };
+  BENCHMARK("distance point/segment") { return atw::distance(p1, segment); };
+  BENCHMARK("rotate") { return atw::rotate(p1, angle); };
+}
+
+TEST_CASE("shield, satellite and earth", "[!benchmark][shield][satellite][earth]")
+{
+  atw::Shield shield{};
+  const atw::Point mouse{ 180.0, 40.0 };
+  const atw::Point nearShield{ 150.0, 36.0 };
+  atw::Satellite satellite{ { 10.0, 10.0 }, { 1.5, 0.5 } };
+  atw::Random random{ 1 };
+  std::vector<atw::Satellite> satellites(1000);
+  std::generate(begin(satellites), end(satellites), [&] { return atw::randomSatellite(random); });
+  atw::Constellation constellation{};
+  constellation.spawn(random, 1000);
+
+  BENCHMARK("shield update")
+  {
+    shield.update(mouse);
+    return shield.polarAngle();
+  };
+  BENCHMARK("shield isNear") { return shield.isNear(nearShield); };
+  BENCHMARK("shield timeOfImpact") { return shield.timeOfImpact(nearShield, { 0.0, 2.5 }); };
+  BENCHMARK("satellite update") { return satellite.update(shield); };
+  BENCHMARK("earth update 1000 satellites")
+  {
+    atw::Earth earth{};
+    return earth.update(satellites);
+  };
+  BENCHMARK("earth update 1000 constellation")
+  {
+    atw::Earth earth{};
+    return earth.update(constellation);
+  };
+}
+
+TEST_CASE("stretch text", "[!benchmark][utilities]")
+{
+  const std::string line{ "BUT, YOU, O YOUNG PADAWAN, WILL YOU TAKE UP THE CHALLENGE" };
+  std::string stretched{};
+
+  BENCHMARK("stretchText") { return atw::stretchText(120, line); };
+  BENCHMARK("stretchText into a buffer")
+  {
+    atw::stretchText(120, line, stretched);
+    return stretched.size();
+  };
+}
+
+TEST_CASE("universe", "[!benchmark][universe]")
+{
+  for (const std::size_t count : { 10U, 1000U, 100000U }) {
+    const atw::Settings settings{
+      .seed = 1, .initialSatellitesCount = count, .maxSatellitesCount = count * 2, .indestructibleEarth = true
+    };
+    auto now = std::chrono::steady_clock::time_point{};
+    atw::Universe universe{ now, settings };
+    universe.update(now, { atw::EventType::Start });
+    atw::Painter painter{};
+
+    BENCHMARK("universe update " + std::to_string(count))
+    {
+      now += atw::FrameInterval;
+      universe.update(now, { atw::EventType::Mouse, { 180.0, 40.0 } });
+      universe.update(now, { atw::EventType::Frame });
+      return universe.getPoints();
+    };
+
+    // Drawn from a snapshot taken once, like the drawing thread, so that the copy is not measured
+    atw::Snapshot snapshot{};
+    universe.snapshot(snapshot);
+    BENCHMARK("snapshot draw " + std::to_string(count)) { return snapshot.draw(painter); };
+  }
+}
+
+TEST_CASE("rewind", "[!benchmark][rewind]")
+{
+  for (const std::size_t count : { 10U, 1000U }) {
+    const atw::Settings settings{
+      .seed = 1, .initialSatellitesCount = count, .maxSatellitesCount = count * 2, .indestructibleEarth = true
+    };
+    auto now = std::chrono::steady_clock::time_point{};
+    atw::Universe universe{ now, settings };
+    atw::Rewind rewind{ universe };
+    atw::applyEvent(universe, rewind, now, { atw::EventType::Start });
+    for (std::size_t frame = 0; frame < 3 * atw::RewindKeyframeInterval; ++frame) {
+      now += atw::FrameInterval;
+      atw::applyEvent(universe, rewind, now, { atw::EventType::Frame });
+    }
+
+    BENCHMARK("rewind record " + std::to_string(count))
+    {
+      now += atw::FrameInterval;
+      atw::applyEvent(universe, rewind, now, { atw::EventType::Frame });
+      return rewind.size();
+    };
+
+    // The last frame of a segment is the slowest to restore, being the farthest from the keyframe
+    atw::Universe restored{ now, settings };
+    BENCHMARK("rewind restore " + std::to_string(count))
+    {
+      rewind.restore(restored, atw::RewindKeyframeInterval - 1, now);
+      return restored.getPoints();
+    };
+  }
+}
+
+TEST_CASE("autopilot", "[!benchmark][autopilot]")
+{
+  for (const std::size_t count : { 10U, 1000U }) {
+    const atw::Settings settings{
+      .seed = 1, .initialSatellitesCount = count, .maxSatellitesCount = count * 2, .indestructibleEarth = true
+    };
+    auto now = std::chrono::steady_clock::time_point{};
+    atw::Universe universe{ now, settings };
+    universe.update(now, { atw::EventType::Start });
+    atw::Autopilot autopilot{ universe, std::chrono::hours{ 1 } };
+
+    BENCHMARK("autopilot plan " + std::to_string(count)) { return autopilot.plan(universe).mouse.x; };
+  }
+}
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Compares two runs of the benchmarks, written with "benchmarks -r json -o FILE".
+
+Exits with 1 if a benchmark is slower in the new run than in the base run by more than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as file:
+        return {result["name"]: result for result in json.load(file)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("base", help="JSON results of the reference build")
+    parser.add_argument("new", help="JSON results of the build to check")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent above which a benchmark regressed (default: 10)")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    regressions = 0
+    print(f"{'benchmark':<40} {'base (ns)':>14} {'new (ns)':>14} {'change':>9}")
+    for name, result in new.items():
+        if name not in base:
+            print(f"{name:<40} {'':>14} {result['mean_ns']:>14.1f}      new")
+            continue
+        before = base[name]["mean_ns"]
+        after = result["mean_ns"]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        regressed = change > args.threshold
+        regressions += regressed
+        print(f"{name:<40} {before:>14.1f} {after:>14.1f} {change:>+8.1f}%{'  REGRESSION' if regressed else ''}")
+    for name in base.keys() - new.keys():
+        print(f"{name:<40} {base[name]['mean_ns']:>14.1f} {'':>14}  removed")
+
+    if regressions:
+        print(f"{regressions} benchmark(s) slower by more than {args.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
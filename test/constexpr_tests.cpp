@@ -1,6 +1,8 @@
 
+#include "../src/stamps.hpp"
 #include "../src/utilities.hpp"
 #include <catch2/catch.hpp>
+#include <numbers>
 
 constexpr unsigned int Factorial(unsigned int number)// NOLINT(misc-no-recursion)
 {
@@ -18,14 +20,71 @@ TEST_CASE("Factorials are computed with constexpr", "[factorial]")
 TEST_CASE("transpose", "[utilities]")
 {
   // ARRANGE
-  static constexpr atw::Point p{ 12.3, -45.6 };
-  static constexpr atw::Offset o{ -7.8, 9.1 };
+  static constexpr atw::Point p{ atw::toScalar(12.3), atw::toScalar(-45.6) };
+  static constexpr atw::Offset o{ atw::toScalar(-7.8), atw::toScalar(9.1) };
 
   // ACT
   static constexpr auto p2 = atw::transpose(p, o);
 
   // ASSERT
-  static constexpr atw::Point expected{ 4.5, -36.5 };
-  REQUIRE(p2.x == Approx(expected.x));
-  REQUIRE(p2.y == Approx(expected.y));
+  REQUIRE(atw::toDouble(p2.x) == Approx(4.5).margin(1e-4));
+  REQUIRE(atw::toDouble(p2.y) == Approx(-36.5).margin(1e-4));
+}
+
+constexpr bool isNear(atw::Fixed value, double expected, double margin = 1e-3)
+{
+  const auto error = static_cast<double>(value) - expected;
+  return error <= margin && -error <= margin;
+}
+
+TEST_CASE("fixed point arithmetic", "[scalar]")
+{
+  STATIC_REQUIRE(atw::Fixed{ 3 } + atw::Fixed{ 0.5 } == atw::Fixed{ 3.5 });
+  STATIC_REQUIRE(atw::Fixed{ 3 } - atw::Fixed{ 4.25 } == atw::Fixed{ -1.25 });
+  STATIC_REQUIRE(atw::Fixed{ 1.5 } * atw::Fixed{ -2 } == atw::Fixed{ -3 });
+  STATIC_REQUIRE(atw::Fixed{ 7 } / atw::Fixed{ 2 } == atw::Fixed{ 3.5 });
+  STATIC_REQUIRE(atw::Fixed{ -1.5 } < atw::Fixed{ 1 });
+  STATIC_REQUIRE(atw::math::floor(atw::Fixed{ -1.5 }) == atw::Fixed{ -2 });
+  STATIC_REQUIRE(static_cast<int>(atw::Fixed{ -1.5 }) == -1);
+  STATIC_REQUIRE(static_cast<int>(atw::Fixed{ 2.75 }) == 2);
+}
+
+TEST_CASE("fixed point functions", "[scalar]")
+{
+  STATIC_REQUIRE(atw::math::sqrt(atw::Fixed{ 16 }) == atw::Fixed{ 4 });
+  STATIC_REQUIRE(isNear(atw::math::sqrt(atw::Fixed{ 2 }), std::numbers::sqrt2));
+  STATIC_REQUIRE(isNear(atw::math::sin(atw::Pi<atw::Fixed> / atw::Fixed{ 6 }), 0.5));
+  STATIC_REQUIRE(isNear(atw::math::sin(atw::Fixed{ -4 }), 0.7568025));
+  STATIC_REQUIRE(isNear(atw::math::cos(atw::Pi<atw::Fixed>), -1.0));
+  STATIC_REQUIRE(isNear(atw::math::atan2(atw::Fixed{ 1 }, atw::Fixed{ 1 }), std::numbers::pi / 4));
+  STATIC_REQUIRE(isNear(atw::math::atan2(atw::Fixed{ -3 }, atw::Fixed{ -4 }), -2.4980915));
+  STATIC_REQUIRE(isNear(atw::math::atan2(atw::Fixed{ 5 }, atw::Fixed{ 0.1 }), 1.5507989));
+}
+
+TEST_CASE("fixed point geometry", "[scalar]")
+{
+  // ARRANGE
+  static constexpr atw::BasicPoint<atw::Fixed> origin{};
+  static constexpr atw::BasicPoint<atw::Fixed> p{ 300, 150 };
+
+  // ACT
+  static constexpr auto rotated = atw::rotate(p, atw::Pi<atw::Fixed> / atw::Fixed{ 2 });
+
+  // ASSERT
+  STATIC_REQUIRE(atw::squaredDistance(origin, p) == atw::Fixed{ 112500 });
+  STATIC_REQUIRE(isNear(rotated.x, -150.0, 0.1));
+  STATIC_REQUIRE(isNear(rotated.y, 300.0, 0.1));
+}
+
+TEST_CASE("circle stamps", "[stamps]")
+{
+  // ACT
+  static constexpr auto ring = atw::circleStamp<2, false>();
+  static constexpr auto disk = atw::circleStamp<2, true>();
+
+  // ASSERT
+  STATIC_REQUIRE(ring.size() == 12);
+  STATIC_REQUIRE(disk.size() == 13);
+  STATIC_REQUIRE(ring[0].dx == -1 && ring[0].dy == -2);
+  STATIC_REQUIRE(disk[0].dx == 0 && disk[0].dy == -2);
 }
@@ -1,12 +1,38 @@
 
+#include "../src/autopilot.hpp"
+#include "../src/batch.hpp"
+#include "../src/input.hpp"
+#include "../src/profiler.hpp"
+#include "../src/recording.hpp"
+#include "../src/rewind.hpp"
+#include "../src/scheduler.hpp"
+#include "../src/terminal.hpp"
+#include "../src/triplebuffer.hpp"
 #include "../src/universe.hpp"
 #include "../src/utilities.hpp"
+#include "../src/workers.hpp"
+#include "allocations.hpp"
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <numbers>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 
 using namespace std::chrono_literals;
 
+// The tests are written with doubles, converted to the simulation's scalar type
+static constexpr atw::Point point(double x, double y) { return { atw::toScalar(x), atw::toScalar(y) }; }
+
+// Absolute error allowed to the computations in fixed point, which has 16 fractional bits
+static constexpr double ScalarMargin = std::is_same_v<atw::Scalar, atw::Fixed> ? 1e-3 : 0.0;
+
 unsigned int Factorial(unsigned int number)// NOLINT(misc-no-recursion)
 {
   return number <= 1 ? number : Factorial(number - 1) * number;
@@ -23,29 +49,29 @@ TEST_CASE("Factorials are computed", "[factorial]")
 TEST_CASE("rotate pi", "[utilities]")
 {
   // ARRANGE
-  static constexpr atw::Point p{ 12.3, -45.6 };
+  static constexpr auto p = point(12.3, -45.6);
 
   // ACT
-  const auto result = atw::rotate(p, std::numbers::pi);
+  const auto result = atw::rotate(p, atw::Pi<>);
 
   // ASSERT
-  static constexpr atw::Point expected{ -12.3, 45.6 };
-  REQUIRE(result.x == Approx(expected.x));
-  REQUIRE(result.y == Approx(expected.y));
+  static constexpr auto expected = point(-12.3, 45.6);
+  REQUIRE(result.x == Approx(expected.x).margin(ScalarMargin));
+  REQUIRE(result.y == Approx(expected.y).margin(ScalarMargin));
 }
 
 TEST_CASE("rotate pi/2", "[utilities]")
 {
   // ARRANGE
-  static constexpr atw::Point p{ 12.3, -45.6 };
+  static constexpr auto p = point(12.3, -45.6);
 
   // ACT
-  const auto result = atw::rotate(p, std::numbers::pi / 2);
+  const auto result = atw::rotate(p, atw::Pi<> / atw::Scalar{ 2 });
 
   // ASSERT
-  static constexpr atw::Point expected{ 45.6, 12.3 };
-  REQUIRE(result.x == Approx(expected.x));
-  REQUIRE(result.y == Approx(expected.y));
+  static constexpr auto expected = point(45.6, 12.3);
+  REQUIRE(result.x == Approx(expected.x).margin(ScalarMargin));
+  REQUIRE(result.y == Approx(expected.y).margin(ScalarMargin));
 }
 
 TEST_CASE("distance point/point", "[utilities]")
@@ -76,13 +102,60 @@ TEST_CASE("distance point/line", "[utilities]")
   REQUIRE(result == Approx(expected));
 }
 
+TEST_CASE("time of impact against a circle", "[utilities]")
+{
+  // ARRANGE
+  static constexpr auto center = point(10.0, 0.0);
+  static constexpr auto radius = atw::Scalar{ 2 };
+
+  // ACT
+  const auto hit = atw::timeOfImpact(point(0.0, 0.0), { atw::Scalar{ 16 }, {} }, center, radius);
+  const auto miss = atw::timeOfImpact(point(0.0, 3.0), { atw::Scalar{ 16 }, {} }, center, radius);
+  const auto tooShort = atw::timeOfImpact(point(0.0, 0.0), { atw::Scalar{ 4 }, {} }, center, radius);
+  const auto inside = atw::timeOfImpact(point(9.0, 0.0), { atw::Scalar{ 1 }, {} }, center, radius);
+  const auto leaving = atw::timeOfImpact(point(9.0, 0.0), { atw::Scalar{ -1 }, {} }, center, radius);
+  // One unit of the fixed point scalars, whose square rounds to 0
+  const auto tinyMove = atw::toScalar(2e-5);
+  const auto crawling = atw::timeOfImpact(point(0.0, 0.0), { tinyMove, tinyMove }, center, radius);
+
+  // ASSERT
+  REQUIRE(hit);
+  REQUIRE(atw::toDouble(*hit) == Approx(0.5).margin(ScalarMargin));
+  REQUIRE_FALSE(miss);
+  REQUIRE_FALSE(tooShort);
+  REQUIRE(inside == atw::Scalar{});
+  REQUIRE_FALSE(leaving);
+  REQUIRE_FALSE(crawling);
+}
+
+TEST_CASE("time of impact against a capsule", "[utilities]")
+{
+  // ARRANGE
+  static constexpr atw::Segment capsule{ point(-10.0, 0.0), point(10.0, 0.0) };
+  static constexpr auto radius = atw::Scalar{ 2 };
+
+  // ACT
+  const auto through = atw::timeOfImpact(point(0.0, 10.0), { {}, atw::Scalar{ -20 } }, capsule, radius);
+  const auto end = atw::timeOfImpact(point(20.0, 0.0), { atw::Scalar{ -16 }, {} }, capsule, radius);
+  const auto beside = atw::timeOfImpact(point(13.0, 10.0), { {}, atw::Scalar{ -20 } }, capsule, radius);
+  const auto leaving = atw::timeOfImpact(point(0.0, 1.0), { {}, atw::Scalar{ 1 } }, capsule, radius);
+
+  // ASSERT
+  REQUIRE(through);
+  REQUIRE(atw::toDouble(*through) == Approx(0.4).margin(ScalarMargin));
+  REQUIRE(end);
+  REQUIRE(atw::toDouble(*end) == Approx(0.5).margin(ScalarMargin));
+  REQUIRE_FALSE(beside);
+  REQUIRE_FALSE(leaving);
+}
+
 TEST_CASE("universe constructor", "[universe]")
 {
   // ARRANGE
   static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
-  double index = 0.0;
+  atw::Scalar index{};
   const auto generateSatellite = [&] {
-    ++index;
+    index += atw::Scalar{ 1 };
     return atw::Satellite{ { index, index }, { index, index } };
   };
 
@@ -95,6 +168,100 @@ TEST_CASE("universe constructor", "[universe]")
   REQUIRE(universe.getState() == atw::State::Intro);
 }
 
+TEST_CASE("universe constructor with settings", "[universe]")
+{
+  // ARRANGE
+  static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
+  static constexpr std::size_t SatellitesCount = 1000;
+  const auto generateSatellite = [] { return atw::Satellite{ atw::EarthCenter, {} }; };
+
+  // ACT
+  atw::Universe universe{ time,
+    generateSatellite,
+    atw::Settings{ .initialSatellitesCount = SatellitesCount, .indestructibleEarth = true } };
+  universe.update(time, { atw::EventType::Start });
+  universe.update(time + atw::FrameInterval, { atw::EventType::Frame });
+
+  // ASSERT
+  REQUIRE(universe.getSatellites().size() == SatellitesCount);
+  REQUIRE(universe.getState() == atw::State::Play);
+}
+
+TEST_CASE("universe fixed timestep", "[universe]")
+{
+  // ARRANGE
+  static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
+  static constexpr auto tick = 10ms;
+  const auto generateSatellite = [] { return atw::Satellite{ { 10.0, 10.0 }, { 1.0, 0.0 } }; };
+  atw::Universe universe{ time, generateSatellite, atw::Settings{ .tickInterval = tick } };
+  universe.update(time, { atw::EventType::Start });
+
+  // ACT
+  universe.update(time + 3 * tick + tick / 2, { atw::EventType::Frame });
+
+  // ASSERT
+  const auto expectedX = 10.0 + 3.0 * std::chrono::duration<double>(tick) / atw::FrameInterval;
+  REQUIRE(universe.getSatellites()[0].getPosition().x == Approx(expectedX));
+  REQUIRE(universe.getInterpolation() == Approx(0.5));
+}
+
+TEST_CASE("universe reports its next visible change", "[universe]")
+{
+  // ARRANGE
+  static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
+  const auto generateSatellite = [] { return atw::Satellite{ atw::EarthCenter, { 1.0, 0.0 } }; };
+  atw::Universe universe{ time, generateSatellite };
+  atw::Snapshot snapshot{};
+
+  // ACT
+  const auto introChange = universe.getNextVisibleChange();
+  universe.update(time, { atw::EventType::Start });
+  const auto playChange = universe.getNextVisibleChange();
+  universe.update(time + atw::FrameInterval, { atw::EventType::Frame });
+  const auto endChange = universe.getNextVisibleChange();
+  universe.snapshot(snapshot);
+  const auto endHash = snapshot.hash();
+  universe.update(time + 2 * atw::FrameInterval, { atw::EventType::Frame });
+  universe.snapshot(snapshot);
+
+  // ASSERT
+  REQUIRE(introChange == time + atw::IntroTextScrollInterval);
+  REQUIRE(playChange == time);
+  REQUIRE(universe.getState() == atw::State::End);
+  REQUIRE(endChange == std::chrono::steady_clock::time_point::max());
+  REQUIRE(snapshot.hash() == endHash);
+}
+
+TEST_CASE("universe frames do not allocate", "[universe]")
+{
+  // ARRANGE
+  static constexpr int FramesCount = 1000;
+  atw::Settings settings{};
+  settings.initialSatellitesCount = 100;
+  settings.maxSatellitesCount = 200;
+  settings.indestructibleEarth = true;
+  settings.collisions = atw::Collisions::Bounce;
+  auto now = std::chrono::steady_clock::now();
+  atw::Universe universe{ now, settings };
+  universe.update(now, { atw::EventType::Start });
+  universe.update(now += atw::FrameInterval, { atw::EventType::Frame });
+
+  // ACT
+  const auto allocationsBefore = allocationsCount();
+  for (int frame = 0; frame < FramesCount; ++frame) {
+    const auto angle = frame * std::numbers::pi / 100;
+    const auto mouse = point(150.0 + 40.0 * std::cos(angle), 75.0 + 40.0 * std::sin(angle));
+    universe.update(now, { atw::EventType::Mouse, mouse });
+    universe.update(now += atw::FrameInterval, { atw::EventType::Frame });
+  }
+  const auto allocationsAfter = allocationsCount();
+
+  // ASSERT
+  REQUIRE(universe.getState() == atw::State::Play);
+  REQUIRE(universe.getSatellites().size() > settings.initialSatellitesCount);
+  REQUIRE(allocationsAfter - allocationsBefore == 0);
+}
+
 #if defined(_MSC_VER) && !defined(__clang__)
 
 // I believe that the warning readability-function-cognitive-complexity should be disabled in tests
@@ -109,9 +276,9 @@ TEST_CASE("universe update", "[universe]")
 {
   // ARRANGE
   static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
-  double index = 0.0;
+  atw::Scalar index{};
   const auto generateSatellite = [&] {
-    ++index;
+    index += atw::Scalar{ 1 };
     return atw::Satellite{ { index, index }, { index, index } };
   };
   atw::Universe universe{ time, generateSatellite };
@@ -305,7 +472,7 @@ TEST_CASE("earth update and die", "[earth]")
     atw::Satellite{ { 0., atw::UniverseHeight }, {} },
     atw::Satellite{ { atw::UniverseWidth, 0. }, {} },
     atw::Satellite{ { atw::UniverseWidth, atw::UniverseHeight }, {} },
-    atw::Satellite{ { atw::EarthCenter.x + atw::EarthRadius / 2.0, atw::EarthCenter.y - atw::EarthRadius / 2.0 }, {} },
+    atw::Satellite{ { atw::EarthCenter.x + atw::EarthRadius / 2, atw::EarthCenter.y - atw::EarthRadius / 2 }, {} },
   };
   atw::Earth earth{};
 
@@ -315,3 +482,925 @@ TEST_CASE("earth update and die", "[earth]")
   // ASSERT
   REQUIRE_FALSE(result);
 }
+
+TEST_CASE("fast satellite does not go through the shield", "[satellite]")
+{
+  // ARRANGE
+  static constexpr auto step = atw::Scalar{ 4 };
+  static constexpr auto start = atw::transpose(atw::EarthCenter, { 0.0, -atw::ShieldRadius - 5.0 });
+  static constexpr atw::Offset velocity{ {}, atw::Scalar{ 2.5 } };
+  const atw::Shield shield{};
+  atw::Satellite satellite{ start, velocity };
+  atw::Constellation constellation{};
+  constellation.push_back(satellite);
+
+  // ACT
+  const auto bounced = satellite.update(shield, step);
+  const auto hits = constellation.update(shield, step);
+
+  // ASSERT
+  REQUIRE(bounced);
+  REQUIRE(hits == 1);
+  REQUIRE(satellite.getVelocity().dy == -velocity.dy);
+  REQUIRE(atw::toDouble(satellite.getPosition().y) == Approx(atw::toDouble(start.y) - 4.0).margin(ScalarMargin));
+  REQUIRE(constellation[0].getPosition().y == satellite.getPosition().y);
+  REQUIRE(constellation[0].getVelocity().dy == satellite.getVelocity().dy);
+}
+
+TEST_CASE("earth is hit along the moves", "[earth]")
+{
+  // ARRANGE
+  atw::Constellation constellation{};
+  constellation.push_back(atw::Satellite{ atw::transpose(atw::EarthCenter, { -10.0, -31.5 }), { 20.0, 0.0 } });
+  atw::Earth earth{};
+
+  // ACT
+  constellation.update(atw::Shield{});
+  const auto result = earth.update(constellation);
+
+  // ASSERT
+  REQUIRE_FALSE(constellation[0].isNearEarth());
+  REQUIRE_FALSE(result);
+}
+
+TEST_CASE("constellation update matches satellite update", "[constellation]")
+{
+  // ARRANGE
+  static constexpr int FramesCount = 500;
+  static constexpr double ShieldRotation = 0.05;
+  atw::Random random{ 1 };
+  std::vector<atw::Satellite> satellites(100);
+  std::generate(begin(satellites), end(satellites), [&] { return atw::randomSatellite(random); });
+  atw::Constellation constellation{};
+  for (const auto &satellite : satellites) constellation.push_back(satellite);
+  atw::Shield shield{};
+  std::size_t expectedHits = 0;
+  std::size_t hits = 0;
+
+  // ACT
+  for (int frame = 0; frame < FramesCount; ++frame) {
+    shield.update(atw::toScalar(frame * ShieldRotation));
+    for (auto &satellite : satellites)
+      if (satellite.update(shield)) ++expectedHits;
+    hits += constellation.update(shield);
+  }
+
+  // ASSERT
+  REQUIRE(expectedHits > 0);
+  REQUIRE(hits == expectedHits);
+  REQUIRE(constellation.size() == satellites.size());
+  for (std::size_t i = 0; i < satellites.size(); ++i) {
+    REQUIRE(constellation[i].getPosition().x == satellites[i].getPosition().x);
+    REQUIRE(constellation[i].getPosition().y == satellites[i].getPosition().y);
+    REQUIRE(constellation[i].getVelocity().dx == satellites[i].getVelocity().dx);
+    REQUIRE(constellation[i].getVelocity().dy == satellites[i].getVelocity().dy);
+    REQUIRE(constellation[i].isRed() == satellites[i].isRed());
+  }
+}
+
+TEST_CASE("constellation bounce collision", "[constellation]")
+{
+  // ARRANGE
+  atw::Constellation constellation{};
+  constellation.push_back(atw::Satellite{ { 10.0, 10.0 }, { 1.0, 0.0 } });
+  constellation.push_back(atw::Satellite{ { 13.0, 10.0 }, { -1.0, 0.0 } });
+  constellation.push_back(atw::Satellite{ { 100.0, 10.0 }, { 1.0, 0.0 } });
+  atw::Grid grid{};
+
+  // ACT
+  constellation.collide(grid, atw::Collisions::Bounce);
+
+  // ASSERT
+  REQUIRE(constellation.size() == 3);
+  REQUIRE(constellation[0].getVelocity().dx == Approx(-1.0).margin(ScalarMargin));
+  REQUIRE(constellation[1].getVelocity().dx == Approx(1.0).margin(ScalarMargin));
+  REQUIRE(constellation[2].getVelocity().dx == Approx(1.0));
+}
+
+TEST_CASE("constellation merge collision", "[constellation]")
+{
+  // ARRANGE
+  atw::Constellation constellation{};
+  constellation.push_back(atw::Satellite{ { 10.0, 10.0 }, { 1.0, 0.0 } });
+  constellation.push_back(atw::Satellite{ { 100.0, 10.0 }, { 1.0, 0.0 } });
+  constellation.push_back(atw::Satellite{ { 13.0, 10.0 }, { -1.0, 2.0 } });
+  atw::Grid grid{};
+
+  // ACT
+  constellation.collide(grid, atw::Collisions::Merge);
+
+  // ASSERT
+  REQUIRE(constellation.size() == 2);
+  REQUIRE(constellation[0].getPosition().x == Approx(11.5));
+  REQUIRE(constellation[0].getVelocity().dx == Approx(0.0));
+  REQUIRE(constellation[0].getVelocity().dy == Approx(1.0));
+  REQUIRE(constellation[1].getPosition().x == Approx(100.0));
+  REQUIRE(grid.size() == 2);
+}
+
+TEST_CASE("constellation handles stay valid when satellites are erased", "[constellation]")
+{
+  // ARRANGE
+  atw::Constellation constellation{};
+  const auto first = constellation.push_back(atw::Satellite{ { 10.0, 10.0 }, { 1.0, 0.0 } });
+  const auto second = constellation.push_back(atw::Satellite{ { 20.0, 10.0 }, { 1.0, 0.0 } });
+  const auto third = constellation.push_back(atw::Satellite{ { 30.0, 10.0 }, { 1.0, 0.0 } });
+
+  // ACT
+  constellation.erase(0);
+  const auto fourth = constellation.push_back(atw::Satellite{ { 40.0, 10.0 }, { 1.0, 0.0 } });
+
+  // ASSERT
+  REQUIRE_FALSE(constellation.find(first));
+  REQUIRE(constellation.find(second) == 1);
+  REQUIRE(constellation.find(third) == 0);
+  REQUIRE(constellation.find(fourth) == 2);
+  REQUIRE(fourth.slot == first.slot);
+  REQUIRE(constellation.handle(0) == third);
+  REQUIRE(constellation[*constellation.find(third)].getPosition().x == atw::Scalar{ 30 });
+  REQUIRE(constellation.oldest() == 1);
+}
+
+TEST_CASE("constellation despawns the satellites worn by the shield", "[constellation]")
+{
+  // ARRANGE
+  static constexpr auto underShield = atw::transpose(atw::EarthCenter, { 0.0, -atw::ShieldRadius });
+  const atw::Shield shield{};
+  atw::Constellation constellation{};
+  constellation.push_back(atw::Satellite{ underShield, { 0.0, 0.0 } });
+  constellation.push_back(atw::Satellite{ { 10.0, 10.0 }, { 1.0, 0.0 } });
+
+  // ACT
+  constellation.update(shield);
+  constellation.update(shield);
+  const auto despawnedBeforeWorn = constellation.despawn(3);
+  const auto despawnedWhenWorn = constellation.despawn(2);
+
+  // ASSERT
+  REQUIRE(despawnedBeforeWorn == 0);
+  REQUIRE(despawnedWhenWorn == 1);
+  REQUIRE(constellation.size() == 1);
+  REQUIRE(constellation.getShieldBounces(0) == 0);
+}
+
+TEST_CASE("universe caps its satellites", "[universe]")
+{
+  static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
+  atw::Scalar nextX{};
+  const auto createSatellite = [&] {
+    return atw::Satellite{ { nextX += atw::Scalar{ 10 }, atw::Scalar{ 10 } }, { atw::Scalar{ 1 }, {} } };
+  };
+  atw::Settings settings{ .initialSatellitesCount = 3, .maxSatellitesCount = 3 };
+  const auto positionsX = [](const atw::Universe &universe) {
+    std::vector<atw::Scalar> result{};
+    for (std::size_t i = 0; i < universe.getSatellites().size(); ++i)
+      result.push_back(universe.getSatellites()[i].getPosition().x);
+    std::sort(begin(result), end(result));
+    return result;
+  };
+
+  SECTION("new satellites are rejected when full")
+  {
+    // ARRANGE
+    settings.overflow = atw::Overflow::Reject;
+    atw::Universe universe{ time, createSatellite, settings };
+
+    // ACT
+    universe.createSatellites(2);
+
+    // ASSERT
+    REQUIRE(positionsX(universe) == std::vector<atw::Scalar>{ 10, 20, 30 });
+  }
+
+  SECTION("new satellites replace the oldest ones when full")
+  {
+    // ARRANGE
+    settings.overflow = atw::Overflow::RecycleOldest;
+    atw::Universe universe{ time, createSatellite, settings };
+
+    // ACT
+    universe.createSatellites(2);
+
+    // ASSERT
+    REQUIRE(positionsX(universe) == std::vector<atw::Scalar>{ 30, 40, 50 });
+  }
+}
+
+TEST_CASE("universe removes the worn satellites from the collisions", "[universe]")
+{
+  // ARRANGE
+  static constexpr int FramesCount = 400;
+  atw::Settings settings{ .seed = 7, .initialSatellitesCount = 400, .indestructibleEarth = true };
+  settings.collisions = atw::Collisions::Bounce;
+  settings.maxShieldBounces = 1;
+  auto now = std::chrono::steady_clock::now();
+  atw::Universe universe{ now, settings };
+  universe.update(now, { atw::EventType::Start });
+
+  // ACT
+  for (int frame = 0; frame < FramesCount; ++frame) {
+    const auto angle = frame * std::numbers::pi / 50;
+    universe.update(now, { atw::EventType::Mouse, point(150.0 + 40.0 * std::cos(angle), 75.0 + 40.0 * std::sin(angle)) });
+    universe.update(now += atw::FrameInterval, { atw::EventType::Frame });
+  }
+
+  // ASSERT
+  REQUIRE(universe.getSatellites().size() < 400);
+  for (std::size_t i = 0; i < universe.getSatellites().size(); ++i)
+    REQUIRE(universe.getSatellites().getShieldBounces(i) == 0);
+}
+
+TEST_CASE("sectors index satellites around the Earth", "[sectors]")
+{
+  // ARRANGE
+  static constexpr auto underShield = atw::transpose(atw::EarthCenter, { 0.0, -atw::ShieldRadius });
+  static constexpr auto oppositeShield = atw::transpose(atw::EarthCenter, { 0.0, atw::ShieldRadius });
+  static constexpr auto onEarth = atw::transpose(atw::EarthCenter, { atw::EarthRadius, 0.0 });
+  static constexpr auto farAway = atw::Point{ 0.0, 0.0 };
+  const std::vector<atw::Scalar> x{ farAway.x, underShield.x, oppositeShield.x, onEarth.x };
+  const std::vector<atw::Scalar> y{ farAway.y, underShield.y, oppositeShield.y, onEarth.y };
+  const atw::Shield shield{};
+  atw::Sectors sectors{};
+
+  // ACT
+  sectors.update(x, y);
+  std::vector<std::size_t> nearShield{};
+  sectors.forEachNearShield(shield.polarAngle(), [&](std::size_t i) { nearShield.push_back(i); });
+
+  // ASSERT
+  REQUIRE(nearShield == std::vector<std::size_t>{ 1 });
+  REQUIRE(sectors.getEarthBand() == std::vector<std::size_t>{ 3 });
+}
+
+TEST_CASE("random numbers are reproducible and in range", "[random]")
+{
+  // ARRANGE
+  atw::Random random{ 42 };
+  atw::Random sameRandom{ 42 };
+  atw::Random otherRandom{ 43 };
+  std::vector<double> values(1000);
+
+  // ACT
+  const auto first = random();
+  const auto same = sameRandom();
+  const auto other = otherRandom();
+  random.fill(values, -2.0, 3.0);
+  const auto [minValue, maxValue] = std::minmax_element(begin(values), end(values));
+  std::vector<int> integers(1000);
+  std::generate(begin(integers), end(integers), [&] { return random.uniform(1, 2); });
+
+  // ASSERT
+  REQUIRE(first == same);
+  REQUIRE(first != other);
+  REQUIRE(*minValue >= -2.0);
+  REQUIRE(*maxValue < 3.0);
+  REQUIRE(std::count(begin(integers), end(integers), 1) > 400);
+  REQUIRE(std::count(begin(integers), end(integers), 2) > 400);
+  REQUIRE(std::count(begin(integers), end(integers), 1) + std::count(begin(integers), end(integers), 2) == 1000);
+}
+
+TEST_CASE("random satellites appear on the sides", "[random]")
+{
+  // ARRANGE
+  atw::Random random{ 1 };
+  atw::Constellation constellation{};
+
+  // ACT
+  constellation.spawn(random, 100);
+
+  // ASSERT
+  REQUIRE(constellation.size() == 100);
+  for (std::size_t i = 0; i < constellation.size(); ++i) {
+    const auto satellite = constellation[i];
+    const auto speed =
+      std::hypot(atw::toDouble(satellite.getVelocity().dx), atw::toDouble(satellite.getVelocity().dy));
+    REQUIRE((satellite.getPosition().x == atw::Scalar{} || satellite.getPosition().x == atw::UniverseWidth));
+    REQUIRE(satellite.getPosition().y >= atw::Scalar{});
+    REQUIRE(satellite.getPosition().y < atw::UniverseHeight);
+    REQUIRE(speed >= Approx(atw::SatelliteMinSpeed));
+    REQUIRE(speed <= Approx(atw::SatelliteMaxSpeed));
+    if (satellite.getPosition().x == atw::Scalar{}) REQUIRE(satellite.getVelocity().dx > atw::Scalar{});
+  }
+}
+
+TEST_CASE("universes with the same seed are the same", "[random]")
+{
+  // ARRANGE
+  static constexpr auto time = std::chrono::steady_clock::time_point{ 0ms };
+  const atw::Settings settings{ .seed = 7, .initialSatellitesCount = 10 };
+
+  // ACT
+  const atw::Universe universe{ time, settings };
+  const atw::Universe sameUniverse{ time, settings };
+
+  // ASSERT
+  for (std::size_t i = 0; i < settings.initialSatellitesCount; ++i) {
+    REQUIRE(universe.getSatellites()[i].getPosition().x == sameUniverse.getSatellites()[i].getPosition().x);
+    REQUIRE(universe.getSatellites()[i].getPosition().y == sameUniverse.getSatellites()[i].getPosition().y);
+    REQUIRE(universe.getSatellites()[i].getVelocity().dx == sameUniverse.getSatellites()[i].getVelocity().dx);
+    REQUIRE(universe.getSatellites()[i].getVelocity().dy == sameUniverse.getSatellites()[i].getVelocity().dy);
+  }
+}
+
+TEST_CASE("parallel update of the satellites matches the serial one", "[universe]")
+{
+  // ARRANGE
+  static constexpr int FramesCount = 200;
+  atw::Settings serialSettings{ .seed = 3, .initialSatellitesCount = 10000, .indestructibleEarth = true };
+  serialSettings.parallelSatellitesCount = std::numeric_limits<std::size_t>::max();
+  atw::Settings parallelSettings = serialSettings;
+  parallelSettings.parallelSatellitesCount = 0;
+  auto now = std::chrono::steady_clock::now();
+  atw::Universe serial{ now, serialSettings };
+  atw::Universe parallel{ now, parallelSettings };
+
+  // ACT
+  for (auto *universe : { &serial, &parallel }) {
+    auto time = now;
+    universe->update(time, { atw::EventType::Start });
+    for (int frame = 0; frame < FramesCount; ++frame) {
+      const auto angle = frame * std::numbers::pi / 50;
+      universe->update(time, { atw::EventType::Mouse, point(150.0 + 40.0 * std::cos(angle), 75.0 + 40.0 * std::sin(angle)) });
+      universe->update(time += atw::FrameInterval, { atw::EventType::Frame });
+    }
+  }
+
+  // ASSERT
+  REQUIRE(serial.getPoints() > 0);
+  REQUIRE(parallel.getPoints() == serial.getPoints());
+  REQUIRE(parallel.hash() == serial.hash());
+}
+
+TEST_CASE("worker pool runs each chunk once", "[workers]")
+{
+  // ARRANGE
+  atw::WorkerPool workers{ 3 };
+  std::vector<std::atomic<int>> runs(1000);
+
+  // ACT
+  for (int i = 0; i < 10; ++i) workers.run(runs.size(), [&](std::size_t chunk) { ++runs[chunk]; });
+
+  // ASSERT
+  REQUIRE(std::all_of(begin(runs), end(runs), [](const std::atomic<int> &count) { return count == 10; }));
+}
+
+TEST_CASE("batch plays independent universes", "[batch]")
+{
+  // ARRANGE
+  static constexpr std::size_t UniversesCount = 8;
+  static constexpr std::size_t MaxFrames = 300;
+  const atw::Settings settings{ .seed = 5 };
+  const auto policy = [](const atw::Universe &, std::size_t frame) {
+    return atw::Event{ frame % 3 == 0 ? atw::EventType::Left : atw::EventType::Unknown };
+  };
+  atw::WorkerPool workers{ 3 };
+
+  // ACT
+  const auto result = atw::runBatch(settings, UniversesCount, MaxFrames, policy, workers);
+
+  // ASSERT
+  REQUIRE(result.universes.size() == UniversesCount);
+  std::size_t destroyedCount = 0;
+  for (std::size_t i = 0; i < UniversesCount; ++i) {
+    auto universeSettings = settings;
+    universeSettings.seed = settings.seed + i;
+    const auto expected = atw::playUniverse(universeSettings, MaxFrames, policy);
+    REQUIRE(result.universes[i].seed == expected.seed);
+    REQUIRE(result.universes[i].frames == expected.frames);
+    REQUIRE(result.universes[i].points == expected.points);
+    REQUIRE(result.universes[i].destroyed == expected.destroyed);
+    if (expected.destroyed) ++destroyedCount;
+  }
+  REQUIRE(result.destroyedCount == destroyedCount);
+  REQUIRE(result.frames.min <= result.frames.median);
+  REQUIRE(result.frames.median <= result.frames.max);
+  REQUIRE(result.frames.max <= MaxFrames);
+}
+
+TEST_CASE("autopilot keeps the Earth alive longer than a still shield", "[autopilot]")
+{
+  // ARRANGE
+  static constexpr std::size_t FramesCount = 600;
+  const atw::Settings settings{ .seed = 11, .initialSatellitesCount = 8 };
+  const auto still = atw::playUniverse(settings, FramesCount, [](const atw::Universe &, std::size_t) {
+    return atw::Event{};
+  });
+  auto now = std::chrono::steady_clock::time_point{};
+  atw::Universe universe{ now, settings };
+  universe.update(now, { atw::EventType::Start });
+  // With a budget that the plans never exceed, so that the horizon does not depend on the machine
+  atw::Autopilot autopilot{ universe, 1h };
+  universe.update(now, autopilot.plan(universe));
+
+  // ACT
+  const auto allocationsBefore = allocationsCount();
+  std::size_t frame = 1;
+  for (; frame < FramesCount && universe.getState() == atw::State::Play; ++frame) {
+    now += settings.frameInterval;
+    universe.update(now, autopilot.plan(universe));
+    universe.update(now, { atw::EventType::Frame });
+  }
+  const auto allocationsAfter = allocationsCount();
+
+  // ASSERT
+  REQUIRE(still.destroyed);
+  REQUIRE(frame > still.frames);
+  REQUIRE(autopilot.getHorizon() == static_cast<std::size_t>(atw::AutopilotHorizon / settings.frameInterval));
+  REQUIRE(allocationsAfter - allocationsBefore == 0);
+}
+
+TEST_CASE("triple buffer hands the latest published value to the reader", "[threads]")
+{
+  // ARRANGE
+  static constexpr int ValuesCount = 100000;
+  atw::TripleBuffer<int> buffer{};
+  int lastRead = 0;
+  bool increasing = true;
+
+  // ACT
+  std::thread writer{ [&] {
+    for (int value = 1; value <= ValuesCount; ++value) {
+      buffer.getBack() = value;
+      buffer.publish();
+    }
+  } };
+  while (lastRead < ValuesCount) {
+    const auto value = buffer.getLatest();
+    increasing = increasing && value >= lastRead;
+    lastRead = value;
+  }
+  writer.join();
+
+  // ASSERT
+  REQUIRE(increasing);
+  REQUIRE(buffer.getLatest() == ValuesCount);
+}
+
+TEST_CASE("event queue keeps the events in order and drops them when full", "[threads]")
+{
+  // ARRANGE
+  atw::EventQueue queue{};
+  for (std::size_t i = 0; i < atw::EventQueue::Capacity; ++i)
+    queue.push({ atw::EventType::Mouse, point(static_cast<double>(i), 0.0) });
+
+  // ACT
+  const auto pushedWhenFull = queue.push({ atw::EventType::Start });
+  std::vector<double> mouseX{};
+  const auto drainedCount = queue.drain([&](const atw::Event &e) { mouseX.push_back(atw::toDouble(e.mouse.x)); });
+  const auto pushedAfterDrain = queue.push({ atw::EventType::Start });
+
+  // ASSERT
+  REQUIRE_FALSE(pushedWhenFull);
+  REQUIRE(drainedCount == atw::EventQueue::Capacity);
+  REQUIRE(std::is_sorted(begin(mouseX), end(mouseX)));
+  REQUIRE(mouseX.back() == atw::EventQueue::Capacity - 1);
+  REQUIRE(pushedAfterDrain);
+}
+
+TEST_CASE("input collapses consecutive mouse moves and keeps the keys in order", "[threads]")
+{
+  // ARRANGE
+  atw::Input input{};
+  input.push({ atw::EventType::Mouse, { 1.0, 1.0 } });
+  input.push({ atw::EventType::Mouse, { 2.0, 2.0 } });
+  input.push({ atw::EventType::Left });
+  input.push({ atw::EventType::Right });
+  input.push({ atw::EventType::Mouse, { 3.0, 3.0 } });
+  input.push({ atw::EventType::Mouse, { 4.0, 4.0 } });
+  input.push({ atw::EventType::Mouse, { 5.0, 5.0 } });
+
+  // ACT
+  std::vector<atw::Event> applied{};
+  const auto appliedCount = input.apply([&](const atw::Event &e) { applied.push_back(e); });
+  const auto appliedAgainCount = input.apply([&](const atw::Event &e) { applied.push_back(e); });
+
+  // ASSERT
+  REQUIRE(appliedCount == 4);
+  REQUIRE(appliedAgainCount == 0);
+  REQUIRE(applied[0].type == atw::EventType::Mouse);
+  REQUIRE(applied[0].mouse.x == atw::Scalar{ 2 });
+  REQUIRE(applied[1].type == atw::EventType::Left);
+  REQUIRE(applied[2].type == atw::EventType::Right);
+  REQUIRE(applied[3].type == atw::EventType::Mouse);
+  REQUIRE(applied[3].mouse.x == atw::Scalar{ 5 });
+  REQUIRE(input.getReceivedCount() == 7);
+  REQUIRE(input.getAppliedCount() == 4);
+}
+
+TEST_CASE("input keeps the keys pushed after a flood of mouse moves", "[threads]")
+{
+  // ARRANGE
+  constexpr auto MovesCount = 4 * atw::EventQueue::Capacity;
+  atw::Input input{};
+  for (std::size_t i = 1; i <= MovesCount; ++i)
+    input.push({ atw::EventType::Mouse, point(static_cast<double>(i % 300), 10.0) });
+  input.push({ atw::EventType::Left });
+  for (std::size_t i = 1; i <= MovesCount; ++i)
+    input.push({ atw::EventType::Mouse, point(static_cast<double>(i % 200), 20.0) });
+
+  // ACT
+  std::vector<atw::Event> applied{};
+  const auto appliedCount = input.apply([&](const atw::Event &e) { applied.push_back(e); });
+
+  // ASSERT
+  REQUIRE(appliedCount == 3);
+  REQUIRE(applied[0].type == atw::EventType::Mouse);
+  REQUIRE(applied[0].mouse.x == atw::toScalar(static_cast<double>(MovesCount % 300)));
+  REQUIRE(applied[0].mouse.y == atw::Scalar{ 10 });
+  REQUIRE(applied[1].type == atw::EventType::Left);
+  REQUIRE(applied[2].type == atw::EventType::Mouse);
+  REQUIRE(applied[2].mouse.x == atw::toScalar(static_cast<double>(MovesCount % 200)));
+  REQUIRE(applied[2].mouse.y == atw::Scalar{ 20 });
+  REQUIRE(input.getReceivedCount() == 2 * MovesCount + 1);
+}
+
+TEST_CASE("replay of a recording ends in the recorded state", "[recording]")
+{
+  // ARRANGE
+  static constexpr int FramesCount = 1000;
+  const atw::Settings settings{ .seed = 3, .initialSatellitesCount = 20, .collisions = atw::Collisions::Bounce };
+  auto now = std::chrono::steady_clock::time_point{ 10s };
+  atw::Universe universe{ now, settings };
+  atw::Rewind rewind{ universe };
+  std::stringstream record{};
+  atw::Recorder recorder{ record, now, settings };
+  const auto play = [&](atw::Event e) {
+    recorder.record(now, e);
+    atw::applyEvent(universe, rewind, now, e);
+  };
+  play({ atw::EventType::Start });
+  for (int frame = 0; frame < FramesCount && universe.getState() == atw::State::Play; ++frame) {
+    now += 49ms + std::chrono::microseconds{ frame % 7 * 300 };
+    if (frame % 3 == 0) play({ atw::EventType::Mouse, point(150.0 + frame % 80, 35.0 + frame % 5 * 4) });
+    if (frame % 50 == 0) play({ atw::EventType::Left });
+    if (frame == 120) play({ atw::EventType::Rewind });
+    play({ atw::EventType::Frame });
+  }
+  recorder.finish(universe.hash());
+
+  // ACT
+  const auto result = atw::replay(record);
+
+  // ASSERT
+  REQUIRE(result.recordedStateHash.has_value());
+  REQUIRE(*result.recordedStateHash == universe.hash());
+  REQUIRE(result.stateHash == universe.hash());
+  REQUIRE(result.points == universe.getPoints());
+  REQUIRE(result.state == universe.getState());
+  REQUIRE(record.str().size() < result.eventsCount * 6);
+}
+
+TEST_CASE("replay rejects what is not a recording", "[recording]")
+{
+  std::stringstream notARecord{ "not a recording" };
+  REQUIRE_THROWS_AS(atw::replay(notARecord), std::runtime_error);
+}
+
+TEST_CASE("replay rejects a recording made with another scalar type", "[recording]")
+{
+  // ARRANGE
+  std::stringstream record{};
+  atw::Recorder recorder{ record, std::chrono::steady_clock::time_point{}, atw::Settings{} };
+  recorder.finish(0);
+  auto bytes = record.str();
+  const auto scalarType = atw::recording::Magic.size() + 1;
+  REQUIRE(static_cast<std::uint64_t>(bytes[scalarType]) == atw::recording::scalarType());
+  bytes[scalarType] = static_cast<char>((atw::recording::scalarType() + 1) % 3);
+  std::stringstream otherScalar{ bytes };
+
+  // ACT
+  const auto result = atw::replay(record);
+
+  // ASSERT
+  REQUIRE(result.recordedStateHash == std::uint64_t{ 0 });
+  REQUIRE_THROWS_AS(atw::replay(otherScalar), std::runtime_error);
+}
+
+// Plays the frames of a game, with the same events whatever the time, and returns the hashes after each frame
+static std::vector<std::uint64_t> playRewindable(atw::Universe &universe,
+  atw::Rewind &rewind,
+  std::chrono::steady_clock::time_point &now,
+  std::size_t firstFrame,
+  std::size_t framesCount)
+{
+  std::vector<std::uint64_t> hashes{};
+  for (auto frame = firstFrame; frame < framesCount; ++frame) {
+    now += 50ms + std::chrono::microseconds{ frame % 5 * 700 };
+    if (frame % 4 == 0) {
+      const atw::Event mouse{ atw::EventType::Mouse, point(100.0 + static_cast<double>(frame), 20.0) };
+      atw::applyEvent(universe, rewind, now, mouse);
+    }
+    atw::applyEvent(universe, rewind, now, { atw::EventType::Frame });
+    hashes.push_back(universe.hash());
+  }
+  return hashes;
+}
+
+TEST_CASE("rewind restores the state of an earlier frame", "[rewind]")
+{
+  // ARRANGE
+  static constexpr std::size_t FramesCount = 100;
+  const atw::Settings settings{
+    .seed = 5, .initialSatellitesCount = 30, .indestructibleEarth = true, .collisions = atw::Collisions::Bounce
+  };
+  auto now = std::chrono::steady_clock::time_point{ 10s };
+  atw::Universe universe{ now, settings };
+  atw::Rewind rewind{ universe };
+  atw::applyEvent(universe, rewind, now, { atw::EventType::Start });
+  const auto hashes = playRewindable(universe, rewind, now, 0, FramesCount);
+  std::size_t bouncesCount = 0;
+  for (std::size_t i = 0; i < rewind.size(); ++i) bouncesCount += rewind.frame(i).bouncesCount;
+  const auto pointsOfFrame = rewind.frame(57).points;
+
+  // ACT
+  now += 1s;
+  rewind.restore(universe, 57, now);
+  const auto restoredHash = universe.hash();
+  const auto restoredPoints = universe.getPoints();
+  const auto replayedHashes = playRewindable(universe, rewind, now, 58, FramesCount);
+  atw::applyEvent(universe, rewind, now, { atw::EventType::Rewind });
+
+  // ASSERT
+  REQUIRE(rewind.size() == 1);
+  REQUIRE(universe.hash() == hashes.front());
+  REQUIRE(restoredHash == hashes[57]);
+  REQUIRE(restoredPoints == pointsOfFrame);
+  REQUIRE(replayedHashes.back() == hashes.back());
+  REQUIRE(bouncesCount > 0);
+}
+
+TEST_CASE("rewind memory bounds the frames kept", "[rewind]")
+{
+  // ARRANGE
+  static constexpr std::size_t FramesCount = 100;
+  const atw::Settings settings{
+    .seed = 6, .initialSatellitesCount = 30, .indestructibleEarth = true, .rewindMemory = 0
+  };
+  auto now = std::chrono::steady_clock::time_point{ 10s };
+  atw::Universe universe{ now, settings };
+  atw::Rewind rewind{ universe };
+  atw::applyEvent(universe, rewind, now, { atw::EventType::Start });
+  const auto hashes = playRewindable(universe, rewind, now, 0, FramesCount);
+  const auto framesCount = rewind.size();
+  const auto pointsOfOldest = rewind.frame(0).points;
+
+  // ACT
+  atw::applyEvent(universe, rewind, now, { atw::EventType::Rewind });
+
+  // ASSERT
+  REQUIRE(rewind.getSegmentsCount() == 2);
+  REQUIRE(framesCount > atw::RewindKeyframeInterval);
+  REQUIRE(framesCount <= 2 * atw::RewindKeyframeInterval);
+  REQUIRE(rewind.size() == 1);
+  REQUIRE(universe.hash() == hashes[FramesCount - framesCount]);
+  REQUIRE(universe.getPoints() == pointsOfOldest);
+}
+
+TEST_CASE("rewind reserves no more than its memory budget", "[rewind]")
+{
+  // ARRANGE
+  static constexpr std::size_t Budget = std::size_t{ 1 } << 20;
+  static constexpr int FramesCount = 200;
+  atw::Settings settings{ .seed = 8, .initialSatellitesCount = 1000, .indestructibleEarth = true };
+  settings.rewindMemory = Budget;
+  auto now = std::chrono::steady_clock::time_point{ 10s };
+  atw::Universe universe{ now, settings };
+
+  // ACT
+  const auto bytesBefore = allocatedBytes();
+  atw::Rewind rewind{ universe };
+  const auto reservedBytes = allocatedBytes() - bytesBefore;
+  atw::applyEvent(universe, rewind, now, { atw::EventType::Start });
+  atw::applyEvent(universe, rewind, now += atw::FrameInterval, { atw::EventType::Frame });
+  const auto allocationsBefore = allocationsCount();
+  for (int frame = 1; frame < FramesCount; ++frame)
+    atw::applyEvent(universe, rewind, now += atw::FrameInterval, { atw::EventType::Frame });
+  const auto allocationsDuringFrames = allocationsCount() - allocationsBefore;
+
+  // ASSERT
+  REQUIRE(rewind.getSegmentsCount() > 2);
+  REQUIRE(reservedBytes <= Budget);
+  REQUIRE(reservedBytes > Budget - atw::Rewind::segmentBytes(universe.getSatellitesCapacity()));
+  REQUIRE(rewind.size() > static_cast<std::size_t>(FramesCount) / 2);
+  REQUIRE(allocationsDuringFrames == 0);
+}
+
+TEST_CASE("painter restores the touched cells", "[painter]")
+{
+  // ARRANGE
+  atw::Painter painter{};
+  const auto firstScene = painter.beginScene(1);
+  const auto sameScene = painter.beginScene(1);
+
+  // ACT
+  painter.touch(atw::Box::around(10, 10, 3));
+  painter.touch(atw::Box::around(0, 0, 3));
+  painter.touch(atw::Box::around(-10, -10, 3));
+  std::vector<atw::Box> restoredBoxes{};
+  painter.restore([&](const atw::Box &box) { restoredBoxes.push_back(box); });
+  std::size_t restoredAgainCount = 0;
+  painter.restore([&](const atw::Box &) { ++restoredAgainCount; });
+
+  // ASSERT
+  REQUIRE(firstScene);
+  REQUIRE_FALSE(sameScene);
+  REQUIRE(restoredBoxes.size() == 2);
+  REQUIRE(restoredBoxes[0].left == 6);
+  REQUIRE(restoredBoxes[0].top == 4);
+  REQUIRE(restoredBoxes[0].right == 13);
+  REQUIRE(restoredBoxes[0].bottom == 15);
+  REQUIRE(restoredBoxes[1].left == 0);
+  REQUIRE(restoredBoxes[1].top == 0);
+  REQUIRE(restoredBoxes[1].right == 3);
+  REQUIRE(restoredBoxes[1].bottom == 3);
+  REQUIRE(restoredAgainCount == 0);
+}
+
+TEST_CASE("terminal writer only writes the changed cells", "[terminal]")
+{
+  // ARRANGE
+  atw::TerminalWriter writer{};
+  ftxui::Screen screen{ 8, 2 };
+  const auto blankFrame = writer.update(screen);
+  const auto sameFrame = writer.update(screen);
+
+  // ACT
+  screen.PixelAt(1, 1).character = "a";
+  screen.PixelAt(2, 1).character = "b";
+  screen.PixelAt(7, 1).character = "c";
+  const auto changedFrame = writer.update(screen);
+  writer.invalidate();
+  const auto invalidatedFrame = writer.update(screen);
+
+  // ASSERT
+  REQUIRE(blankFrame == "\x1B[0m\x1B[2J");
+  REQUIRE(sameFrame.empty());
+  REQUIRE(changedFrame == "\x1B[2;2Hab\x1B[4Cc");
+  REQUIRE(writer.getLastFrameBytes() == invalidatedFrame.size());
+  REQUIRE(invalidatedFrame == "\x1B[0m\x1B[2J" + changedFrame);
+}
+
+TEST_CASE("terminal reader translates the keys and the mouse's reports", "[terminal]")
+{
+  // ARRANGE
+  atw::TerminalReader reader{};
+  std::vector<atw::TerminalReader::Input> inputs{};
+  const auto read = [&](std::string_view bytes) {
+    reader.parse(bytes, [&](const atw::TerminalReader::Input &input) { inputs.push_back(input); });
+  };
+
+  // ACT
+  read("p\x1B[D\x1B[C\x1BOD\r\x7F\x1B[A");
+  read("\x1B[<35;12");
+  const auto splitCount = inputs.size();
+  read(";5M\x1B[<0;3;4m");
+  read("\x1B");
+
+  // ASSERT
+  using Key = atw::TerminalReader::Key;
+  REQUIRE(splitCount == 6);
+  REQUIRE(inputs.size() == 9);
+  REQUIRE(inputs[0].key == Key::Character);
+  REQUIRE(inputs[0].character == 'p');
+  REQUIRE(inputs[1].key == Key::Left);
+  REQUIRE(inputs[2].key == Key::Right);
+  REQUIRE(inputs[3].key == Key::Left);
+  REQUIRE(inputs[4].key == Key::Return);
+  REQUIRE(inputs[5].key == Key::Backspace);
+  REQUIRE(inputs[6].key == Key::Mouse);
+  REQUIRE(inputs[6].x == 11);
+  REQUIRE(inputs[6].y == 4);
+  REQUIRE(inputs[7].key == Key::Mouse);
+  REQUIRE(inputs[7].x == 2);
+  REQUIRE(inputs[7].y == 3);
+  REQUIRE(inputs[8].key == Key::Escape);
+}
+
+TEST_CASE("profiler statistics and trace", "[profiler]")
+{
+  // ARRANGE
+  static constexpr auto start = std::chrono::steady_clock::time_point{ 1s };
+  auto profiler = std::make_unique<atw::Profiler>();
+  for (int i = 1; i <= 100; ++i) profiler->record(atw::Phase::Update, start + i * 1ms, i * 1us);
+  profiler->record(atw::Phase::Draw, start, 5us);
+  std::ostringstream trace{};
+
+  // ACT
+  const auto statistics = profiler->statistics();
+  profiler->writeTrace(trace);
+
+  // ASSERT
+  const auto &update = statistics[static_cast<std::size_t>(atw::Phase::Update)];
+  REQUIRE(update.count == 100);
+  REQUIRE(update.average == 50500ns);
+  REQUIRE(update.p99 == 99us);
+  REQUIRE(statistics[static_cast<std::size_t>(atw::Phase::Draw)].average == 5us);
+  REQUIRE(statistics[static_cast<std::size_t>(atw::Phase::Earth)].count == 0);
+  REQUIRE(trace.str().starts_with(R"({"traceEvents":[)"));
+  REQUIRE(trace.str().find(R"({"name":"draw","ph":"X","pid":1,"tid":)") != std::string::npos);
+  REQUIRE(trace.str().find(R"(,"ts":0,"dur":5})") != std::string::npos);
+}
+
+TEST_CASE("phase timers only record when the profiler is enabled", "[profiler]")
+{
+  // ARRANGE
+  const auto countRenders = [] {
+    return atw::profiler.statistics()[static_cast<std::size_t>(atw::Phase::Render)].count;
+  };
+  const auto before = countRenders();
+
+  // ACT
+  {
+    const atw::PhaseTimer disabledTimer{ atw::Phase::Render };
+  }
+  atw::profiler.enable(true);
+  {
+    const atw::PhaseTimer enabledTimer{ atw::Phase::Render };
+  }
+  atw::profiler.enable(false);
+
+  // ASSERT
+  REQUIRE(countRenders() == before + 1);
+}
+
+TEST_CASE("scheduler calls at a fixed rate and stops immediately", "[scheduler]")
+{
+  // ARRANGE
+  std::atomic<int> calls{};
+  std::uint64_t framesCount = 0;
+  atw::JitterHistogram::Counts jitter{};
+  const auto start = std::chrono::steady_clock::now();
+
+  // ACT
+  {
+    atw::Scheduler scheduler{ 1ms, [&] {
+                               ++calls;
+                               return atw::Scheduler::TimePoint{};
+                             } };
+    while (calls < 10) std::this_thread::sleep_for(1ms);
+    framesCount = scheduler.getFramesCount();
+    jitter = scheduler.getJitter();
+  }
+  {
+    const atw::Scheduler idleScheduler{ 1h, [] { return atw::Scheduler::TimePoint{}; } };
+  }
+
+  // ASSERT
+  REQUIRE(std::chrono::steady_clock::now() - start < 10s);
+  REQUIRE(framesCount >= 10);
+  REQUIRE(std::accumulate(begin(jitter), end(jitter), std::uint64_t{}) >= 10);
+}
+
+TEST_CASE("scheduler sleeps until it is needed or woken", "[scheduler]")
+{
+  // ARRANGE
+  std::atomic<int> calls{};
+  const auto start = std::chrono::steady_clock::now();
+  atw::Scheduler scheduler{ 1ms, [&] {
+                             ++calls;
+                             return atw::Scheduler::Never;
+                           } };
+  while (calls < 1) std::this_thread::sleep_for(1ms);
+
+  // ACT
+  std::this_thread::sleep_for(20ms);
+  const int idleCalls = calls;
+  scheduler.wake();
+  while (calls < 2 && std::chrono::steady_clock::now() - start < 10s) std::this_thread::sleep_for(1ms);
+
+  // ASSERT
+  REQUIRE(idleCalls == 1);
+  REQUIRE(calls == 2);
+  REQUIRE(scheduler.getFramesCount() >= 1);
+  REQUIRE(scheduler.getFramesCount() <= 2);
+}
+
+TEST_CASE("scheduler does not count the deadlines skipped on request as missed", "[scheduler]")
+{
+  // ARRANGE
+  std::atomic<int> calls{};
+  atw::Scheduler scheduler{ 1ms, [&] {
+                             // Longer than several intervals, but then asking for a much later frame
+                             std::this_thread::sleep_for(5ms);
+                             ++calls;
+                             return std::chrono::steady_clock::now() + 1h;
+                           } };
+
+  // ACT
+  while (calls < 1 || scheduler.getFramesCount() < 1) std::this_thread::sleep_for(1ms);
+  std::this_thread::sleep_for(10ms);
+
+  // ASSERT
+  REQUIRE(calls == 1);
+  REQUIRE(scheduler.getMissedDeadlinesCount() == 0);
+}
+
+TEST_CASE("jitter histogram buckets", "[scheduler]")
+{
+  REQUIRE(atw::JitterHistogram::bucketOf(0us) == 0);
+  REQUIRE(atw::JitterHistogram::bucketOf(1us) == 1);
+  REQUIRE(atw::JitterHistogram::bucketOf(3us) == 2);
+  REQUIRE(atw::JitterHistogram::bucketOf(4us) == 3);
+  REQUIRE(atw::JitterHistogram::bucketOf(1h) == atw::JitterHistogram::BucketsCount - 1);
+  REQUIRE(atw::JitterHistogram::bucketStart(3) == 4us);
+}